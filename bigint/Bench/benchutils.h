@@ -0,0 +1,23 @@
+#ifndef BENCHUTILS_H
+#define BENCHUTILS_H
+
+#include "bigint.h"
+
+#include <random>
+#include <vector>
+
+// Random number of exactly nBits bits, so that all limb widths work on the same sizes
+inline BigInt randomBigInt(size_t nBits, std::mt19937_64& gen)
+{
+    std::vector<word> heap((nBits + bitsInWord - 1) / bitsInWord);
+    for (word& limb : heap)
+        limb = static_cast<word>(gen());
+
+    size_t topBits = nBits % bitsInWord;
+    if (topBits != 0)
+        heap.back() &= ~word(0) >> (bitsInWord - topBits);
+    heap.back() |= word(1) << ((nBits - 1) % bitsInWord);
+    return BigInt(std::move(heap));
+}
+
+#endif // BENCHUTILS_H
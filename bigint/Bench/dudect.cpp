@@ -0,0 +1,121 @@
+#include "benchutils.h"
+#include "bigintfunct.h"
+#include "modcontext.h"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+// dudect-style leakage check: time the same operation on two classes of secret inputs,
+// a fixed exponent and random ones, and compare the timing distributions with Welch's t-test.
+// |t| above this means the timing depends on the exponent with overwhelming probability.
+constexpr double leakageThreshold = 4.5;
+
+// Share of the first measurements used to find the cropping percentile only
+constexpr size_t warmupShare = 10;
+
+// Online mean and variance (Welford)
+class Moments
+{
+public:
+    void push(double value)
+    {
+        ++_count;
+        double delta = value - _mean;
+        _mean += delta / _count;
+        _m2 += delta * (value - _mean);
+    }
+
+    double mean() const
+    {
+        return _mean;
+    }
+
+    double variance() const
+    {
+        return _count > 1 ? _m2 / (_count - 1) : 0;
+    }
+
+    size_t count() const
+    {
+        return _count;
+    }
+
+private:
+    size_t _count = 0;
+    double _mean = 0;
+    double _m2 = 0;
+};
+
+double welchT(const Moments& fixed, const Moments& random)
+{
+    double denominator = std::sqrt(fixed.variance() / fixed.count() + random.variance() / random.count());
+    return denominator == 0 ? 0 : (fixed.mean() - random.mean()) / denominator;
+}
+
+// Largest |t| over the full and the cropped (below the 90th percentile) measurements,
+// cropping removes the long tail of interrupts and other system noise
+double maxLeakage(const std::function<BigInt(const BigInt&)>& operation, size_t nBits,
+                  size_t measurements, std::mt19937_64& gen)
+{
+    const BigInt fixedExponent = BigInt(1) << (nBits - 1);
+    std::bernoulli_distribution chooseClass;
+
+    std::vector<double> warmup;
+    double cropThreshold = 0;
+    Moments full[2];
+    Moments cropped[2];
+    for (size_t i = 0; i < measurements; ++i) {
+        bool isRandom = chooseClass(gen);
+        BigInt exponent = isRandom ? randomBigInt(nBits, gen) : fixedExponent;
+
+        auto start = steady_clock::now();
+        BigInt result = operation(exponent);
+        double elapsed = static_cast<double>(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+
+        if (i < measurements / warmupShare) {
+            warmup.push_back(elapsed);
+            continue;
+        }
+        if (cropThreshold == 0 and not warmup.empty()) {
+            std::sort(warmup.begin(), warmup.end());
+            cropThreshold = warmup[warmup.size() * 9 / 10];
+        }
+
+        full[isRandom].push(elapsed);
+        if (elapsed <= cropThreshold)
+            cropped[isRandom].push(elapsed);
+    }
+    return std::max(std::abs(welchT(full[0], full[1])), std::abs(welchT(cropped[0], cropped[1])));
+}
+
+int main(int argc, const char* argv[])
+{
+    size_t nBits = argc > 1 ? std::stoul(argv[1]) : 256;
+    size_t measurements = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+    std::mt19937_64 gen(2019);
+    const BigInt base = randomBigInt(nBits, gen);
+    const ModContext context(randomBigInt(nBits, gen) | 1);
+
+    const std::vector<std::pair<std::string, std::function<BigInt(const BigInt&)>>> operations = {
+        {"powMod", [&](const BigInt& exponent) { return context.powMod(base, exponent); }},
+        {"powModConstTime", [&](const BigInt& exponent) { return context.powModConstTime(base, exponent); }},
+    };
+
+    fmt::print("bits,operation,measurements,max_t,verdict\n");
+    for (const auto& [name, operation] : operations) {
+        double t = maxLeakage(operation, nBits, measurements, gen);
+        fmt::print("{},{},{},{:.2f},{}\n", nBits, name, measurements, t,
+                   t > leakageThreshold ? "leak" : "no evidence of leakage");
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "benchutils.h"
+#include "bigintfunct.h"
+#include "fixedbase.h"
+#include "modcontext.h"
+
+#include <fmt/core.h>
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+// Every operation is repeated until it runs for at least this long
+constexpr milliseconds minMeasuredTime(200);
+
+// Number of terms of the measured multi-exponentiation
+constexpr size_t multiExpTerms = 16;
+
+double measureNs(const std::function<void()>& operation)
+{
+    size_t iterations = 0;
+    auto start = steady_clock::now();
+    auto elapsed = steady_clock::duration::zero();
+    do {
+        operation();
+        ++iterations;
+        elapsed = steady_clock::now() - start;
+    } while (elapsed < minMeasuredTime);
+    return static_cast<double>(duration_cast<nanoseconds>(elapsed).count()) / iterations;
+}
+
+int main(int argc, const char* argv[])
+{
+    std::vector<size_t> sizes = {512, 1024, 2048, 4096, 8192};
+    if (argc > 1) {
+        sizes.clear();
+        for (int i = 1; i < argc; ++i)
+            sizes.push_back(std::stoul(argv[i]));
+    }
+
+    std::mt19937_64 gen(2019);
+    fmt::print("word_bits,bits,operation,ns_per_op\n");
+    for (size_t nBits : sizes) {
+        BigInt left = randomBigInt(nBits, gen);
+        BigInt right = randomBigInt(nBits, gen);
+        BigInt wide = randomBigInt(2 * nBits, gen);
+        if (left < right)
+            std::swap(left, right);
+        BigInt oddModulo = randomBigInt(nBits, gen) | 1;
+        ModContext context(right);
+        FixedBaseComb comb(left, ModContext(oddModulo), nBits);
+        std::vector<BigInt> bases;
+        std::vector<BigInt> exponents;
+        for (size_t i = 0; i < multiExpTerms; ++i) {
+            bases.push_back(randomBigInt(nBits, gen));
+            exponents.push_back(randomBigInt(nBits, gen));
+        }
+
+        std::vector<std::pair<std::string, std::function<void()>>> operations = {
+            {"add", [&] { BigInt result = left + right; }},
+            {"sub", [&] { BigInt result = left - right; }},
+            {"mul", [&] { BigInt result = left * right; }},
+            {"sqr", [&] { BigInt result = square(left); }},
+            {"divmod", [&] { auto result = divisionRemainder(wide, right); }},
+            {"mod", [&] { BigInt result = wide % right; }},
+            {"reduce", [&] { BigInt result = context.reduce(wide); }},
+            {"modpow", [&] { BigInt result = modPow(left, right, oddModulo); }},
+            {"combpow", [&] { BigInt result = comb.pow(right); }},
+            {"multiexp16", [&] { BigInt result = multiExp(bases, exponents, oddModulo); }},
+        };
+
+        for (const auto& [name, operation] : operations)
+            fmt::print("{},{},{},{:.0f}\n", bitsInWord, nBits, name, measureNs(operation));
+    }
+    return 0;
+}
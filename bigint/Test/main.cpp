@@ -1,4 +1,9 @@
 #include "bigintfunct.h"
+#include "bigintkernel.h"
+#include "expschedule.h"
+#include "exptable.h"
+#include "fixedbase.h"
+#include "modcontext.h"
 
 #include <gtest/gtest.h>
 
@@ -6,16 +11,140 @@
 
 #include <openssl/bn.h>
 
+#include <atomic>
 #include <iostream>
 #include <cstdlib>
+#include <new>
 #include <random>
 #include <chrono>
 #include <fstream>
+#include <sstream>
 
 using namespace std::chrono;
 
 constexpr size_t maxTestedBitsSize = 512;
 
+// Every heap allocation of the test binary is counted to check the allocation-free paths.
+// All the forms of the global allocator are replaced (plain, array, nothrow, aligned and
+// sized), so every delete matches its new, also for the allocations of the runtime.
+static std::atomic<size_t> allocationsCount{0};
+
+static void* countedAllocate(size_t size, size_t alignment = 0) noexcept
+{
+    ++allocationsCount;
+    if (alignment == 0)
+        return std::malloc(size);
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(alignment, (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment);
+}
+
+static void* countedAllocateOrThrow(size_t size, size_t alignment = 0)
+{
+    if (void* memory = countedAllocate(size, alignment))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size)
+{
+    return countedAllocateOrThrow(size);
+}
+
+void* operator new[](size_t size)
+{
+    return countedAllocateOrThrow(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return countedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return countedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
 TEST(BigIntFunct, SimpleStrings)
 {
     gmp_randclass randomMachine(gmp_randinit_default);
@@ -31,6 +160,91 @@ TEST(BigIntFunct, SimpleStrings)
     }
 }
 
+TEST(BigIntFunct, LongDecimalStrings)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    std::uniform_int_distribution<size_t> distr(1, 100000);
+    for (size_t i = 0; i < 20; ++i) {
+        mpz_class gmpBigNum = randomMachine.get_z_bits(distr(gen));
+        BigInt myBigNum(gmpBigNum.get_str(10), BigInt::Dec);
+        ASSERT_TRUE(std::string(gmpBigNum.get_str(16)) == myBigNum.getStr(BigInt::Hex));
+        ASSERT_TRUE(std::string(gmpBigNum.get_str(10)) == myBigNum.getStr(BigInt::Dec));
+
+        std::ostringstream stream;
+        myBigNum.write(stream, BigInt::Dec);
+        ASSERT_TRUE(std::string(gmpBigNum.get_str(10)) == stream.str());
+    }
+
+    // Zero runs at the split points of the conversion
+    for (size_t digits : {1, 19, 600, 1217, 4865, 20000}) {
+        std::string power = "1" + std::string(digits, '0');
+        std::string nines(digits, '9');
+        std::string sparse = "5" + std::string(digits, '0') + "7";
+        for (const std::string& number : {power, nines, sparse})
+            ASSERT_EQ(number, BigInt(number, BigInt::Dec).getStr(BigInt::Dec));
+    }
+    EXPECT_EQ(BigInt("0000", BigInt::Dec).getStr(BigInt::Dec), "0");
+    EXPECT_EQ(BigInt(0).getStr(BigInt::Dec), "0");
+    EXPECT_THROW(BigInt("12a", BigInt::Dec), std::invalid_argument);
+}
+
+TEST(BigIntFunct, CharsConversions)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    std::uniform_int_distribution<size_t> distr(1, 5000);
+    std::vector<char> buffer;
+    for (size_t i = 0; i < 200; ++i) {
+        mpz_class gmpBigNum = randomMachine.get_z_bits(distr(gen));
+        for (BigInt::Radix radix : {BigInt::Bin, BigInt::Dec, BigInt::Hex}) {
+            std::string expected = gmpBigNum.get_str(static_cast<int>(radix));
+            BigInt myBigNum;
+            auto [end, parseError] = myBigNum.fromChars(expected.data(), expected.data() + expected.size(), radix);
+            ASSERT_EQ(parseError, std::errc());
+            ASSERT_EQ(end, expected.data() + expected.size());
+
+            buffer.assign(myBigNum.charsLen(radix), '\0');
+            ASSERT_LE(expected.size(), buffer.size());
+            auto [last, writeError] = myBigNum.toChars(buffer.data(), buffer.data() + buffer.size(), radix);
+            ASSERT_EQ(writeError, std::errc());
+            ASSERT_EQ(expected, std::string(buffer.data(), last));
+        }
+    }
+
+    // Any case of hexadecimal digits, the output is lowercase
+    BigInt upper("DEADbeef0123456789ABCDEF", BigInt::Hex);
+    EXPECT_EQ(upper.getStr(BigInt::Hex), "deadbeef0123456789abcdef");
+
+    // Malformed input is reported at the first invalid digit and leaves the number intact
+    BigInt number(42);
+    std::string hex = "0123456789abcdef0123456789abcdefg12";
+    auto [invalidHex, hexError] = number.fromChars(hex.data(), hex.data() + hex.size(), BigInt::Hex);
+    EXPECT_EQ(hexError, std::errc::invalid_argument);
+    EXPECT_EQ(invalidHex, hex.data() + hex.find('g'));
+    std::string bin = "1010201";
+    auto [invalidBin, binError] = number.fromChars(bin.data(), bin.data() + bin.size(), BigInt::Bin);
+    EXPECT_EQ(binError, std::errc::invalid_argument);
+    EXPECT_EQ(invalidBin, bin.data() + 4);
+    std::string dec = "12x";
+    EXPECT_EQ(number.fromChars(dec.data(), dec.data() + dec.size(), BigInt::Dec).ec, std::errc::invalid_argument);
+    EXPECT_TRUE(number == 42);
+    EXPECT_THROW(BigInt("1010201", BigInt::Bin), std::invalid_argument);
+
+    // Too short buffers, and no allocations for numbers with inline limbs
+    char small[4];
+    EXPECT_EQ(BigInt(0x12345).toChars(small, small + sizeof(small), BigInt::Hex).ec, std::errc::value_too_large);
+    char digits[80];
+    BigInt inlineNumber("123456789012345678901234567890", BigInt::Dec);
+    size_t allocationsBefore = allocationsCount;
+    auto [last, error] = inlineNumber.toChars(digits, digits + sizeof(digits), BigInt::Dec);
+    EXPECT_EQ(allocationsBefore, allocationsCount);
+    EXPECT_EQ(error, std::errc());
+    EXPECT_EQ(std::string(digits, last), "123456789012345678901234567890");
+    EXPECT_EQ(BigInt(0).getStr(BigInt::Bin), "0");
+    EXPECT_EQ(BigInt("", BigInt::Hex).getStr(BigInt::Hex), "0");
+}
+
 TEST(BigIntFunct, And)
 {
     gmp_randclass randomMachine(gmp_randinit_default);
@@ -141,6 +355,35 @@ TEST(BigIntFunct, ShiftLeft)
     }
 }
 
+TEST(BigIntFunct, ShiftByWords)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+
+    // Whole-word distances, distances past the end and everything in between
+    const std::vector<size_t> shifts = {0, 1, bitsInWord - 1, bitsInWord, bitsInWord + 1, 2 * bitsInWord,
+                                        5 * bitsInWord + 3, 1024, 4096};
+    for (size_t i = 1; i < maxTestedBitsSize; i += 13) {
+        mpz_class gmpBigNum = randomMachine.get_z_bits(i);
+        const BigInt myBigNum(gmpBigNum.get_str(16));
+
+        for (size_t shift : shifts) {
+            mpz_class shiftedLeft = gmpBigNum << shift;
+            mpz_class shiftedRight = gmpBigNum >> shift;
+
+            ASSERT_TRUE(std::string(shiftedLeft.get_str(16)) == (myBigNum << shift).getStr(BigInt::Hex));
+            ASSERT_TRUE(std::string(shiftedRight.get_str(16)) == (myBigNum >> shift).getStr(BigInt::Hex));
+
+            BigInt inPlace = myBigNum;
+            inPlace <<= shift;
+            ASSERT_TRUE(std::string(shiftedLeft.get_str(16)) == inPlace.getStr(BigInt::Hex));
+            inPlace >>= shift;
+            ASSERT_TRUE(myBigNum == inPlace);
+            inPlace >>= shift;
+            ASSERT_TRUE(std::string(shiftedRight.get_str(16)) == inPlace.getStr(BigInt::Hex));
+        }
+    }
+}
+
 TEST(BigIntFunct, BitPositionGetSet)
 {
     constexpr size_t numberOfBits = 100;
@@ -156,6 +399,93 @@ TEST(BigIntFunct, BitPositionGetSet)
     ASSERT_TRUE(setted == myBigNum);
 }
 
+TEST(BigIntFunct, NormalizedHeap)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    for (size_t i = 1; i < maxTestedBitsSize; ++i) {
+        mpz_class gmpBigNum = randomMachine.get_z_bits(i);
+        BigInt myBigNum(gmpBigNum.get_str(16));
+        size_t gmpBitsLen = gmpBigNum == 0 ? 0 : mpz_sizeinbase(gmpBigNum.get_mpz_t(), 2);
+        ASSERT_EQ(gmpBitsLen, myBigNum.bitsLen());
+        ASSERT_EQ(std::max((gmpBitsLen + bitsInWord - 1) / bitsInWord, size_t(1)), myBigNum.wordLen());
+    }
+
+    // Leading zero words never stay in the heap
+    EXPECT_EQ(BigInt(4, 0).wordLen(), 1u);
+    EXPECT_TRUE(BigInt(4, 0).isZero());
+    EXPECT_EQ(BigInt(std::string(100, '0')).wordLen(), 1u);
+    EXPECT_EQ(BigInt(std::vector<word>{5, 0, 0}).wordLen(), 1u);
+
+    // A default constructed number is zero as well
+    BigInt zero;
+    EXPECT_TRUE(zero.isZero());
+    EXPECT_EQ(zero.wordLen(), 1u);
+    EXPECT_EQ(zero.getStr(BigInt::Hex), "0");
+    EXPECT_EQ(zero.getStr(BigInt::Dec), "0");
+    EXPECT_EQ(zero, BigInt(0));
+
+    // So is a moved-from one, with inline and with heap limbs
+    for (size_t bits : {size_t(10), size_t(1000)}) {
+        BigInt source = (BigInt(1) << bits) + 1;
+        BigInt moved(std::move(source));
+        EXPECT_TRUE(source.isZero());
+        EXPECT_EQ(source.wordLen(), 1u);
+        EXPECT_EQ(moved.bitsLen(), bits + 1);
+
+        BigInt assigned;
+        assigned = std::move(moved);
+        EXPECT_TRUE(moved.isZero());
+        EXPECT_EQ(moved.wordLen(), 1u);
+        EXPECT_EQ(moved.getStr(BigInt::Dec), "0");
+        EXPECT_EQ(assigned.bitsLen(), bits + 1);
+        moved += 5;
+        EXPECT_EQ(moved, BigInt(5));
+    }
+
+    BigInt number = 1;
+    number.setBitAt(3 * bitsInWord, true);
+    EXPECT_EQ(number.wordLen(), 4u);
+    EXPECT_EQ(number.bitsLen(), 3 * bitsInWord + 1);
+    number.setBitAt(3 * bitsInWord, false);
+    EXPECT_EQ(number.wordLen(), 1u);
+    EXPECT_EQ(number.bitsLen(), 1u);
+    number.setBitAt(10 * bitsInWord, false);
+    EXPECT_EQ(number.wordLen(), 1u);
+
+    BigInt difference = (BigInt(1) << (4 * bitsInWord)) - 1;
+    difference -= difference;
+    EXPECT_TRUE(difference.isZero());
+}
+
+TEST(BigIntFunct, InlineLimbs)
+{
+    // Everything up to 256 bits stays inside the object
+    size_t allocationsBefore = allocationsCount;
+    BigInt small = (BigInt(1) << 200) + BigInt(12345);
+    BigInt copy = small * BigInt(2);
+    copy >>= 1;
+    copy += BigInt(1);
+    EXPECT_TRUE(copy - small == 1);
+    EXPECT_EQ(allocationsBefore, allocationsCount);
+
+    // Bigger numbers spill to the heap, moving them hands the buffer over
+    BigInt big = BigInt(1) << 1000;
+    const word* bigLimbs = big.getHeap().data();
+    allocationsBefore = allocationsCount;
+    BigInt moved = std::move(big);
+    EXPECT_EQ(allocationsBefore, allocationsCount);
+    EXPECT_EQ(bigLimbs, moved.getHeap().data());
+    EXPECT_EQ(moved.bitsLen(), 1001u);
+
+    LimbVector limbs(3, 7);
+    limbs.resize(40, 1);
+    EXPECT_FALSE(limbs.isInline());
+    EXPECT_EQ(limbs[2], word(7));
+    EXPECT_EQ(limbs[39], word(1));
+    LimbVector copied = limbs;
+    EXPECT_TRUE(std::equal(limbs.begin(), limbs.end(), copied.begin(), copied.end()));
+}
+
 TEST(BigIntFunct, Comparisons)
 {
     constexpr size_t numberOfBits = 256;
@@ -175,6 +505,32 @@ TEST(BigIntFunct, Comparisons)
     }
 }
 
+TEST(BigIntFunct, ThreeWayComparison)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    for (size_t i = 1; i < maxTestedBitsSize; ++i) {
+        // Different lengths as well as equal lengths with a common prefix
+        std::uniform_int_distribution<size_t> distr(1, i);
+        mpz_class left = randomMachine.get_z_bits(i);
+        mpz_class right = i % 2 == 0 ? mpz_class(randomMachine.get_z_bits(distr(gen)))
+                                     : mpz_class(left ^ (mpz_class(1) << (distr(gen) - 1)));
+
+        BigInt myLeft(left.get_str(16));
+        BigInt myRight(right.get_str(16));
+
+        size_t allocationsBefore = allocationsCount;
+        int result = compare(myLeft, myRight);
+        ASSERT_EQ(allocationsBefore, allocationsCount);
+
+        int expected = cmp(left, right);
+        ASSERT_EQ((expected > 0) - (expected < 0), result);
+        ASSERT_EQ(-result, compare(myRight, myLeft));
+        ASSERT_EQ(0, compare(myLeft, myLeft));
+        ASSERT_EQ(left != right, myLeft != myRight);
+    }
+}
+
 TEST(BigIntFunct, Addition)
 {
     gmp_randclass randomMachine(gmp_randinit_default);
@@ -194,6 +550,22 @@ TEST(BigIntFunct, Addition)
     }
 }
 
+TEST(BigIntFunct, AdditionCarryChain)
+{
+    // All-ones operands force the carry (borrow) through every word
+    for (size_t i = 1; i < maxTestedBitsSize; i += 31) {
+        mpz_class allOnes = (mpz_class(1) << i) - 1;
+        BigInt myAllOnes(allOnes.get_str(16));
+
+        mpz_class sum = allOnes + 1;
+        BigInt mySum = myAllOnes + BigInt(1);
+        ASSERT_TRUE(std::string(sum.get_str(16)) == mySum.getStr(BigInt::Hex));
+
+        BigInt myDiff = mySum - BigInt(1);
+        ASSERT_TRUE(std::string(allOnes.get_str(16)) == myDiff.getStr(BigInt::Hex));
+    }
+}
+
 TEST(BigIntFunct, Substraction)
 {
     gmp_randclass randomMachine(gmp_randinit_default);
@@ -240,6 +612,30 @@ TEST(BigIntFunct, DivisionRemainder)
     }
 }
 
+TEST(BigIntFunct, DivisionRemainderEdgeCases)
+{
+    // Divisors with words close to the word boundaries trigger the rare corrections
+    // of the quotient estimate, numerators are built as quotient * divisor + remainder
+    gmp_randclass randomMachine(gmp_randinit_default);
+    for (size_t i = 2; i < maxTestedBitsSize; i += 3) {
+        std::vector<mpz_class> denominators = {
+            (mpz_class(1) << i) - 1,
+            (mpz_class(1) << i) + 1,
+            mpz_class(1) << (i - 1),
+            ((mpz_class(1) << i) - 1) << (i / 2),
+        };
+        for (const mpz_class& right : denominators) {
+            mpz_class quotient = (mpz_class(1) << (i + 17)) - 1 - randomMachine.get_z_bits(3);
+            mpz_class remainder = right - 1;
+            mpz_class left = quotient * right + remainder;
+
+            auto[myQuotient, myRemainder] = divisionRemainder(BigInt(left.get_str(16)), BigInt(right.get_str(16)));
+            ASSERT_TRUE(std::string(quotient.get_str(16)) == myQuotient.getStr(BigInt::Hex));
+            ASSERT_TRUE(std::string(remainder.get_str(16)) == myRemainder.getStr(BigInt::Hex));
+        }
+    }
+}
+
 TEST(BigIntFunct, Multiplication)
 {
     gmp_randclass randomMachine(gmp_randinit_default);
@@ -259,6 +655,140 @@ TEST(BigIntFunct, Multiplication)
     }
 }
 
+TEST(BigIntFunct, MultiplicationAlgorithms)
+{
+    // Low crossovers push small operands through every algorithm and their recursion
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    const MulThresholds defaultThresholds = mulThresholds();
+    const std::vector<MulThresholds> tested = {{4, 12}, {8, 20}, defaultThresholds};
+    for (const MulThresholds& thresholds : tested) {
+        mulThresholds() = thresholds;
+        for (size_t i = 64; i < 40 * maxTestedBitsSize; i += 397) {
+            std::uniform_int_distribution<size_t> distr(i / 3, i);
+            mpz_class left = randomMachine.get_z_bits(i);
+            mpz_class right = randomMachine.get_z_bits(distr(gen));
+            mpz_class product = left * right;
+
+            BigInt myProduct = BigInt(left.get_str(16)) * BigInt(right.get_str(16));
+            ASSERT_TRUE(std::string(product.get_str(16)) == myProduct.getStr(BigInt::Hex));
+        }
+    }
+    mulThresholds() = defaultThresholds;
+}
+
+TEST(BigIntFunct, Square)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    const MulThresholds defaultThresholds = mulThresholds();
+    const std::vector<MulThresholds> tested = {{4, 12}, {8, 20}, defaultThresholds};
+    for (const MulThresholds& thresholds : tested) {
+        mulThresholds() = thresholds;
+        for (size_t i = 1; i < 40 * maxTestedBitsSize; i += 211) {
+            mpz_class op = randomMachine.get_z_bits(i);
+            mpz_class product = op * op;
+
+            BigInt mySquare = square(BigInt(op.get_str(16)));
+            ASSERT_TRUE(std::string(product.get_str(16)) == mySquare.getStr(BigInt::Hex));
+        }
+    }
+    mulThresholds() = defaultThresholds;
+
+    // Every limb all ones gives the longest carry chains
+    BigInt allOnes(std::vector<word>(7, ~word(0)));
+    EXPECT_TRUE(square(allOnes) == allOnes * allOnes);
+    EXPECT_TRUE(square(0) == 0);
+}
+
+TEST(BigIntFunct, InPlaceOperators)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    for (size_t i = 2; i < maxTestedBitsSize; i += 3) {
+        std::uniform_int_distribution<size_t> distr(1, i);
+        mpz_class left = randomMachine.get_z_bits(i);
+        mpz_class right = randomMachine.get_z_bits(distr(gen));
+        if (left < right)
+            std::swap(left, right);
+        if (right == 0)
+            continue;
+        size_t shift = distr(gen);
+
+        const BigInt myLeft(left.get_str(16));
+        const BigInt myRight(right.get_str(16));
+        auto check = [&](const mpz_class& expected, BigInt& actual) {
+            ASSERT_TRUE(std::string(expected.get_str(16)) == actual.getStr(BigInt::Hex));
+        };
+
+        BigInt result = myLeft;
+        check(left + right, result += myRight);
+        check(left, result -= myRight);
+        check(left * right, result *= myRight);
+        result = myLeft;
+        check(left % right, result %= myRight);
+        result = myLeft;
+        check(left & right, result &= myRight);
+        result = myLeft;
+        check(left | right, result |= myRight);
+        result = myLeft;
+        check(left ^ right, result ^= myRight);
+        result = myLeft;
+        check(left >> shift, result >>= shift);
+        result = myLeft;
+        check(left << shift, result <<= shift);
+
+        // Operands aliasing the destination
+        result = myLeft;
+        check(2 * left, result += result);
+        result = myLeft;
+        check(left * left, result *= result);
+        result = myLeft;
+        check(0, result ^= result);
+        result = myRight;
+        mul(result, myLeft, result);
+        check(left * right, result);
+        result = myRight;
+        sqr(result, result);
+        check(right * right, result);
+    }
+}
+
+TEST(BigIntFunct, AllocationFreeLoops)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    BigInt left(mpz_class(randomMachine.get_z_bits(2048)).get_str(16));
+    BigInt right(mpz_class(randomMachine.get_z_bits(2048)).get_str(16));
+
+    // Once the destination and the scratch buffers have grown, products reuse them
+    BigInt result;
+    mul(result, left, right);
+    sqr(result, left);
+    size_t allocationsBefore = allocationsCount;
+    for (size_t i = 0; i < 10; ++i) {
+        mul(result, left, right);
+        sqr(result, right);
+    }
+    EXPECT_EQ(allocationsBefore, allocationsCount);
+
+    // Modular exponentiation allocates for its result only, the number of allocations
+    // does not depend on the exponent length (powMod sizes its table from the exponent,
+    // so the table is fixed here)
+    ModContext context(BigInt(mpz_class(randomMachine.get_z_bits(2048) | 1).get_str(16)));
+    const ExpTable table(left, 5, context);
+    BigInt shortExponent(mpz_class(randomMachine.get_z_bits(64)).get_str(16));
+    BigInt longExponent(mpz_class(randomMachine.get_z_bits(2048)).get_str(16));
+    table.slidingWindowExp(longExponent);
+
+    allocationsBefore = allocationsCount;
+    table.slidingWindowExp(shortExponent);
+    size_t shortAllocations = allocationsCount - allocationsBefore;
+
+    allocationsBefore = allocationsCount;
+    table.slidingWindowExp(longExponent);
+    size_t longAllocations = allocationsCount - allocationsBefore;
+    EXPECT_EQ(shortAllocations, longAllocations);
+}
+
 TEST(BigIntFunct, GCD)
 {
     gmp_randclass randomMachine(gmp_randinit_default);
@@ -306,6 +836,241 @@ TEST(BigIntFunct, Reduction)
     }
 }
 
+TEST(BigIntFunct, ModPow)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    for (size_t i = 2; i < maxTestedBitsSize; i += 7) {
+        std::uniform_int_distribution<size_t> distr(1, i);
+        mpz_class base = randomMachine.get_z_bits(distr(gen));
+        mpz_class exponent = randomMachine.get_z_bits(distr(gen));
+        mpz_class modulo = randomMachine.get_z_bits(i);
+        if (modulo == 0)
+            continue;
+
+        mpz_class result;
+        mpz_powm(result.get_mpz_t(), base.get_mpz_t(), exponent.get_mpz_t(), modulo.get_mpz_t());
+
+        BigInt myResult = modPow(BigInt(base.get_str(16)), BigInt(exponent.get_str(16)), BigInt(modulo.get_str(16)));
+        ASSERT_TRUE(std::string(result.get_str(16)) == myResult.getStr(BigInt::Hex));
+    }
+}
+
+TEST(BigIntFunct, ModPowConstTime)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    for (size_t i = 2; i < maxTestedBitsSize; i += 7) {
+        std::uniform_int_distribution<size_t> distr(1, 2 * i);
+        mpz_class base = randomMachine.get_z_bits(distr(gen));
+        mpz_class exponent = randomMachine.get_z_bits(distr(gen));
+        mpz_class modulo = randomMachine.get_z_bits(i) | 1;
+
+        mpz_class result;
+        mpz_powm(result.get_mpz_t(), base.get_mpz_t(), exponent.get_mpz_t(), modulo.get_mpz_t());
+
+        BigInt myResult = modPowConstTime(BigInt(base.get_str(16)), BigInt(exponent.get_str(16)),
+                                          BigInt(modulo.get_str(16)));
+        ASSERT_TRUE(std::string(result.get_str(16)) == myResult.getStr(BigInt::Hex));
+    }
+
+    EXPECT_TRUE(modPowConstTime(5, 0, 7) == 1);
+    EXPECT_THROW(modPowConstTime(5, 3, 8), std::logic_error);
+}
+
+TEST(BigIntFunct, ExpTable)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    std::uniform_int_distribution<size_t> distr(1, maxTestedBitsSize);
+    for (word k = 1; k <= 6; ++k) {
+        mpz_class base = randomMachine.get_z_bits(distr(gen));
+        mpz_class oddModulo = randomMachine.get_z_bits(distr(gen)) | 1;
+        mpz_class evenModulo = randomMachine.get_z_bits(distr(gen)) << 1;
+        if (evenModulo == 0)
+            evenModulo = 2;
+        BigInt myBase(base.get_str(16));
+        const ExpTable plain(myBase, k);
+        const ExpTable odd(myBase, k, BigInt(oddModulo.get_str(16)));
+        const ExpTable even(myBase, k, BigInt(evenModulo.get_str(16)));
+
+        // One table serves any number of exponents
+        for (size_t i = 0; i < 10; ++i) {
+            mpz_class smallExponent = randomMachine.get_z_bits(10);
+            BigInt mySmallExponent(smallExponent.get_str(16));
+            mpz_class power;
+            mpz_pow_ui(power.get_mpz_t(), base.get_mpz_t(), smallExponent.get_ui());
+            ASSERT_TRUE(std::string(power.get_str(16)) == plain.mAryLRExp(mySmallExponent).getStr(BigInt::Hex));
+            ASSERT_TRUE(std::string(power.get_str(16)) == plain.slidingWindowExp(mySmallExponent).getStr(BigInt::Hex));
+
+            mpz_class exponent = randomMachine.get_z_bits(distr(gen));
+            BigInt myExponent(exponent.get_str(16));
+            for (const auto& [modulo, table] : {std::make_pair(oddModulo, &odd), std::make_pair(evenModulo, &even)}) {
+                mpz_powm(power.get_mpz_t(), base.get_mpz_t(), exponent.get_mpz_t(), modulo.get_mpz_t());
+                ASSERT_TRUE(std::string(power.get_str(16)) == table->mAryLRExp(myExponent).getStr(BigInt::Hex));
+                ASSERT_TRUE(std::string(power.get_str(16)) == table->slidingWindowExp(myExponent).getStr(BigInt::Hex));
+            }
+        }
+    }
+
+    // Tables refer to a given context instead of copying it
+    ModContext context(BigInt("fedcba987654321"));
+    const ExpTable table(7, 4, context);
+    EXPECT_EQ(table.getModContext(), &context);
+    EXPECT_EQ(ExpTable(7, 4).getModContext(), nullptr);
+
+    // Windows out of range are rejected
+    for (word k : {word(0), maxExpTableK + 1, word(bitsInWord)}) {
+        EXPECT_THROW(ExpTable(7, k), std::logic_error) << k;
+        EXPECT_THROW(ExpTable(7, k, context), std::logic_error) << k;
+        // 0 is adaptiveExpWindowK for the methods of BigInt
+        if (k != adaptiveExpWindowK) {
+            EXPECT_THROW(BigInt(7).mAryLRExp(100, k), std::logic_error) << k;
+            EXPECT_THROW(BigInt(7).binarySWExp(100, k), std::logic_error) << k;
+        }
+    }
+    EXPECT_EQ(ExpTable(3, maxExpTableK, context).slidingWindowExp(5), BigInt(243));
+}
+
+TEST(BigIntFunct, AdaptiveWindow)
+{
+    for (auto method : {ExpWindowMethod::MAry, ExpWindowMethod::SlidingWindow}) {
+        EXPECT_EQ(expWindowK(0, 16, method), 1u);
+        EXPECT_EQ(expWindowK(4, 16, method), 1u);
+        for (size_t bits = 1; bits < 100000; bits *= 2)
+            EXPECT_LE(expWindowK(bits, 16, method), expWindowK(2 * bits, 16, method));
+    }
+    EXPECT_GE(expWindowK(1024, 16), 5u);
+    EXPECT_LE(expWindowK(1024, 16), 6u);
+
+    // Exponents of thousands of bits in every radix
+    gmp_randclass randomMachine(gmp_randinit_default);
+    mpz_class base = randomMachine.get_z_bits(1024);
+    mpz_class exponent = randomMachine.get_z_bits(4096);
+    mpz_class modulo = randomMachine.get_z_bits(1024) | 1;
+    mpz_class power;
+    mpz_powm(power.get_mpz_t(), base.get_mpz_t(), exponent.get_mpz_t(), modulo.get_mpz_t());
+    for (BigInt::Radix radix : {BigInt::Bin, BigInt::Dec, BigInt::Hex}) {
+        int gmpRadix = static_cast<int>(radix);
+        BigInt myResult = modPow(BigInt(base.get_str(gmpRadix), radix), BigInt(exponent.get_str(gmpRadix), radix),
+                                 BigInt(modulo.get_str(gmpRadix), radix));
+        ASSERT_TRUE(std::string(power.get_str(gmpRadix)) == myResult.getStr(radix));
+    }
+}
+
+TEST(BigIntFunct, FixedBaseComb)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    const std::vector<std::pair<size_t, size_t>> shapes = {{1, 1}, {4, 1}, {3, 4}, {6, 2}, {8, 3}};
+    for (const auto& [teeth, tables] : shapes) {
+        std::uniform_int_distribution<size_t> distr(2, maxTestedBitsSize);
+        mpz_class base = randomMachine.get_z_bits(distr(gen));
+        mpz_class modulo = randomMachine.get_z_bits(distr(gen)) + 2;
+        // At least one column per table
+        size_t maxExponentBits = std::max(distr(gen), teeth * tables);
+        FixedBaseComb comb(BigInt(base.get_str(16)), ModContext(BigInt(modulo.get_str(16))),
+                           maxExponentBits, teeth, tables);
+
+        // A table saved and loaded back gives the same powers
+        std::stringstream stream;
+        comb.save(stream);
+        FixedBaseComb loaded = FixedBaseComb::load(stream);
+
+        std::uniform_int_distribution<size_t> exponentBits(0, maxExponentBits + 8);
+        for (size_t i = 0; i < 20; ++i) {
+            mpz_class exponent = randomMachine.get_z_bits(exponentBits(gen));
+            mpz_class power;
+            mpz_powm(power.get_mpz_t(), base.get_mpz_t(), exponent.get_mpz_t(), modulo.get_mpz_t());
+
+            BigInt myExponent(exponent.get_str(16));
+            ASSERT_TRUE(std::string(power.get_str(16)) == comb.pow(myExponent).getStr(BigInt::Hex));
+            ASSERT_TRUE(std::string(power.get_str(16)) == loaded.pow(myExponent).getStr(BigInt::Hex));
+        }
+    }
+
+    std::stringstream malformed("fixed-base-comb-v1\n7\n3\n16 2 1\n1\n");
+    EXPECT_THROW(FixedBaseComb::load(malformed), std::runtime_error);
+    // Sizes are checked before anything is allocated for them
+    for (const char* shape : {"64 17 1", "64 0 1", "64 4 0", "64 4 17", "0 4 1", "18446744073709551615 16 18446744073709551615"}) {
+        std::stringstream oversized(std::string("fixed-base-comb-v1\n7\n3\n") + shape + "\n1\n3\n");
+        EXPECT_THROW(FixedBaseComb::load(oversized), std::runtime_error);
+    }
+    EXPECT_THROW(FixedBaseComb(3, ModContext(BigInt(7)), 64, 17, 1), std::logic_error);
+    EXPECT_THROW(FixedBaseComb(3, ModContext(BigInt(7)), 64, 4, 17), std::logic_error);
+
+    // A table of another base is refused
+    std::stringstream saved;
+    FixedBaseComb(3, ModContext(BigInt(1000003)), 64, 4, 2).save(saved);
+    std::string table = saved.str();
+    table.replace(table.find("\n3\n"), 3, "\n5\n");
+    std::stringstream foreign(table);
+    EXPECT_THROW(FixedBaseComb::load(foreign), std::runtime_error);
+}
+
+TEST(BigIntFunct, MultiExp)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    std::uniform_int_distribution<size_t> distr(1, maxTestedBitsSize / 2);
+    // Straus below 32 terms, Pippenger from there on
+    for (size_t count : {0, 1, 2, 5, 31, 32, 100}) {
+        for (mpz_class modulo : {mpz_class(randomMachine.get_z_bits(distr(gen)) | 1),
+                                 mpz_class((randomMachine.get_z_bits(distr(gen)) << 1) + 2)}) {
+            std::vector<BigInt> bases;
+            std::vector<BigInt> exponents;
+            mpz_class product = 1 % modulo;
+            for (size_t i = 0; i < count; ++i) {
+                mpz_class base = randomMachine.get_z_bits(distr(gen));
+                mpz_class exponent = randomMachine.get_z_bits(distr(gen));
+                mpz_class power;
+                mpz_powm(power.get_mpz_t(), base.get_mpz_t(), exponent.get_mpz_t(), modulo.get_mpz_t());
+                product = product * power % modulo;
+                bases.emplace_back(base.get_str(16));
+                exponents.emplace_back(exponent.get_str(16));
+            }
+
+            BigInt myProduct = multiExp(bases, exponents, BigInt(modulo.get_str(16)));
+            ASSERT_TRUE(std::string(product.get_str(16)) == myProduct.getStr(BigInt::Hex));
+        }
+    }
+
+    EXPECT_THROW(multiExp({2, 3}, {1}, 7), std::logic_error);
+}
+
+TEST(BigIntFunct, ModContext)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    for (size_t i = 2; i < maxTestedBitsSize; i += 7) {
+        mpz_class modulo = randomMachine.get_z_bits(i);
+        if (modulo == 0)
+            continue;
+        ModContext context(BigInt(modulo.get_str(16)));
+
+        // Barrett range and anything longer which falls back to division
+        std::uniform_int_distribution<size_t> distr(1, 3 * i);
+        for (size_t j = 0; j < 10; ++j) {
+            mpz_class op = randomMachine.get_z_bits(distr(gen));
+            mpz_class remainder = op % modulo;
+            ASSERT_TRUE(std::string(remainder.get_str(16)) == context.reduce(BigInt(op.get_str(16))).getStr(BigInt::Hex));
+        }
+
+        mpz_class left = randomMachine.get_z_bits(i) % modulo;
+        mpz_class right = randomMachine.get_z_bits(i) % modulo;
+        mpz_class product = (left * right) % modulo;
+        mpz_class square = (left * left) % modulo;
+        BigInt myLeft(left.get_str(16));
+        BigInt myRight(right.get_str(16));
+        ASSERT_TRUE(std::string(product.get_str(16)) == context.mulMod(myLeft, myRight).getStr(BigInt::Hex));
+        ASSERT_TRUE(std::string(square.get_str(16)) == context.sqrMod(myLeft).getStr(BigInt::Hex));
+
+        mpz_class power;
+        mpz_powm(power.get_mpz_t(), left.get_mpz_t(), right.get_mpz_t(), modulo.get_mpz_t());
+        ASSERT_TRUE(std::string(power.get_str(16)) == context.powMod(myLeft, myRight).getStr(BigInt::Hex));
+    }
+}
+
 
 TEST(BigIntFunct, binaryLRExp)
 {
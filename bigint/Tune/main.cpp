@@ -0,0 +1,195 @@
+#include "bigintkernel.h"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+// Calibrates the multiplication crossovers and the squaring cost for this host
+// and emits them as bigintconfig.h.
+// Usage: tune-exponentiation [output header path], prints the header when no path is given.
+// Only the limb width of the build is measured, the values of the other one are kept from the
+// header being replaced (the checked-in one when printing or writing a new file).
+
+constexpr milliseconds minMeasuredTime(50);
+// The faster algorithm has to win on this many consecutive sizes to set the crossover
+constexpr size_t requiredWins = 3;
+constexpr size_t unreachable = ~size_t(0) / 4;
+
+double measureNs(const std::function<void()>& operation)
+{
+    size_t iterations = 0;
+    auto start = steady_clock::now();
+    auto elapsed = steady_clock::duration::zero();
+    do {
+        operation();
+        ++iterations;
+        elapsed = steady_clock::now() - start;
+    } while (elapsed < minMeasuredTime);
+    return static_cast<double>(duration_cast<nanoseconds>(elapsed).count()) / iterations;
+}
+
+// Smallest size from which switching the top level of a product to the next algorithm
+// (threshold = size) beats leaving it to the previous one (threshold = size + 1).
+size_t findCrossover(size_t MulThresholds::* threshold, size_t from, size_t to, std::mt19937_64& gen)
+{
+    size_t wins = 0;
+    for (size_t len = from; len <= to; len += std::max<size_t>(1, len / 16)) {
+        std::vector<word> left(len);
+        std::vector<word> right(len);
+        std::vector<word> product(2 * len);
+        for (size_t i = 0; i < len; ++i) {
+            left[i] = static_cast<word>(gen());
+            right[i] = static_cast<word>(gen());
+        }
+        auto multiply = [&] { mulWords(product.data(), left.data(), len, right.data(), len); };
+
+        mulThresholds().*threshold = len + 1;
+        double without = measureNs(multiply);
+        mulThresholds().*threshold = len;
+        double with = measureNs(multiply);
+        fmt::print(stderr, "{:>5} words: {:>12.0f} ns vs {:>12.0f} ns\n", len, without, with);
+
+        wins = with < without ? wins + 1 : 0;
+        if (wins == requiredWins)
+            return len;
+    }
+    return to;
+}
+
+// Squaring cost in percent of the multiplication cost at 1, 4, 16, 64 and 256 words,
+// comma separated as BIGINT_SQR_COST_PERCENT expects it
+std::string measureSqrCostPercent(std::mt19937_64& gen)
+{
+    std::string result;
+    for (size_t len = 1; len <= 256; len *= 4) {
+        std::vector<word> left(len);
+        std::vector<word> right(len);
+        std::vector<word> product(2 * len);
+        for (size_t i = 0; i < len; ++i) {
+            left[i] = static_cast<word>(gen());
+            right[i] = static_cast<word>(gen());
+        }
+        double multiplication = measureNs([&] { mulWords(product.data(), left.data(), len, right.data(), len); });
+        double squaring = measureNs([&] { sqrWords(product.data(), left.data(), len); });
+        unsigned percent = static_cast<unsigned>(std::min(100.0, 100 * squaring / multiplication + 0.5));
+        fmt::print(stderr, "{:>5} words: {:>12.0f} ns vs {:>12.0f} ns\n", len, squaring, multiplication);
+
+        result += (result.empty() ? "" : ", ") + std::to_string(percent);
+    }
+    return result;
+}
+
+// Values defined for the limb width that is not measured, the #define lines under a
+// "#if BIGINT_WORD_BITS == n" branch of the other width
+std::map<std::string, std::string> otherWidthValues(const std::string& path)
+{
+    const std::string measured = fmt::format("#if BIGINT_WORD_BITS == {}", bitsInWord);
+    std::map<std::string, std::string> values;
+    // One entry per open conditional, true in a branch of the other width
+    std::vector<bool> otherWidth;
+    std::ifstream header(path);
+    for (std::string line; std::getline(header, line);) {
+        std::istringstream tokens(line);
+        std::string directive;
+        tokens >> directive;
+        if (directive == "#if" or directive == "#ifdef" or directive == "#ifndef") {
+            otherWidth.push_back(line.rfind("#if BIGINT_WORD_BITS", 0) == 0 and line != measured);
+        } else if ((directive == "#else" or directive.rfind("#elif", 0) == 0) and not otherWidth.empty()) {
+            // The branches of a width condition alternate between the two widths
+            otherWidth.back() = not otherWidth.back();
+        } else if (directive == "#endif" and not otherWidth.empty()) {
+            otherWidth.pop_back();
+        } else if (directive == "#define" and std::find(otherWidth.begin(), otherWidth.end(), true) != otherWidth.end()) {
+            std::string name;
+            std::string value;
+            tokens >> name;
+            std::getline(tokens >> std::ws, value);
+            values.emplace(name, value);
+        }
+    }
+    return values;
+}
+
+int main(int argc, const char* argv[])
+{
+    std::mt19937_64 gen(2019);
+
+    std::string previousHeader = argc > 1 and std::ifstream(argv[1]) ? argv[1] : BIGINT_CONFIG_HEADER;
+    std::map<std::string, std::string> other = otherWidthValues(previousHeader);
+    for (const char* name : {"BIGINT_KARATSUBA_THRESHOLD", "BIGINT_TOOM3_THRESHOLD", "BIGINT_SQR_COST_PERCENT"}) {
+        if (other.count(name) == 0) {
+            fmt::print(stderr, "{} has no {} for {}-bit words\n", previousHeader, name, 96 - bitsInWord);
+            return 1;
+        }
+    }
+
+    fmt::print(stderr, "Karatsuba crossover ({}-bit words)\n", bitsInWord);
+    mulThresholds().toom3 = unreachable;
+    size_t karatsuba = findCrossover(&MulThresholds::karatsuba, 4, 256, gen);
+    mulThresholds().karatsuba = karatsuba;
+
+    fmt::print(stderr, "Toom-3 crossover ({}-bit words)\n", bitsInWord);
+    size_t toom3 = findCrossover(&MulThresholds::toom3, std::max<size_t>(12, 3 * karatsuba), 1024, gen);
+    mulThresholds().toom3 = toom3;
+
+    fmt::print(stderr, "Squaring cost ({}-bit words)\n", bitsInWord);
+    std::string sqrCost = measureSqrCostPercent(gen);
+
+    // Same layout as the checked-in header: the 64-bit value first, the 32-bit one in #else
+    auto definition = [&](const std::string& name, const std::string& measuredValue) {
+        const std::string& wide = bitsInWord == 64 ? measuredValue : other[name];
+        const std::string& narrow = bitsInWord == 64 ? other[name] : measuredValue;
+        return fmt::format("#ifndef {0}\n"
+                           "#if BIGINT_WORD_BITS == 64\n"
+                           "#define {0} {1}\n"
+                           "#else\n"
+                           "#define {0} {2}\n"
+                           "#endif\n"
+                           "#endif\n",
+                           name, wide, narrow);
+    };
+    std::string header = fmt::format(
+                "#ifndef BIGINTCONFIG_H\n"
+                "#define BIGINTCONFIG_H\n"
+                "\n"
+                "// Multiplication crossovers, in words of the shorter operand. Below the Karatsuba\n"
+                "// threshold schoolbook multiplication is used, from the Toom-3 one on Toom-Cook 3-way.\n"
+                "// Generated by tune-exponentiation for {0}-bit words on the build host, the values\n"
+                "// for the other limb width were kept from the previous header.\n"
+                "{1}"
+                "\n"
+                "{2}"
+                "\n"
+                "// Cost of a squaring in percent of the cost of a multiplication at 1, 4, 16, 64 and\n"
+                "// 256 words, the cost model of the exponentiation window size uses it\n"
+                "{3}"
+                "\n"
+                "#endif // BIGINTCONFIG_H\n",
+                bitsInWord, definition("BIGINT_KARATSUBA_THRESHOLD", std::to_string(karatsuba)),
+                definition("BIGINT_TOOM3_THRESHOLD", std::to_string(toom3)),
+                definition("BIGINT_SQR_COST_PERCENT", sqrCost));
+
+    if (argc > 1) {
+        std::FILE* output = std::fopen(argv[1], "w");
+        if (output == nullptr) {
+            fmt::print(stderr, "Can not open {}\n", argv[1]);
+            return 1;
+        }
+        fmt::print(output, "{}", header);
+        std::fclose(output);
+    } else {
+        fmt::print("{}", header);
+    }
+    return 0;
+}
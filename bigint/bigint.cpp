@@ -7,18 +7,236 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <optional>
 
+#include "bigintcodec.h"
 #include "bigintfunct.h"
+#include "bigintkernel.h"
+#include "expschedule.h"
+#include "exptable.h"
+
+// Biggest power of 10 which fits into a word and the number of its zeros
+constexpr word maxDecDivisibleWord = bitsInWord == 64 ? word(10000000000000000000ull) : word(1000000000);
+constexpr size_t decDigitsInWord = bitsInWord == 64 ? 19 : 9;
+// Decimal conversion splits numbers (strings) longer than this many words (chunks
+// of decDigitsInWord digits) in halves by a power of 10, shorter ones go chunk by chunk
+constexpr size_t decConversionThreshold = 32;
+// Every chunk holds more than 3 bits per digit
+constexpr size_t decBufferChunks = decConversionThreshold * bitsInWord / (3 * decDigitsInWord) + 2;
+
+// floor(2^(2n) / op) for an n-bit op by Newton's iteration: the reciprocal of the top half
+// of op, shifted, is refined by one step and then corrected by at most a few units.
+// Costs a few multiplications of the size of op, unlike the schoolbook division.
+static BigInt reciprocal(const BigInt& op)
+{
+    size_t n = op.bitsLen();
+    BigInt scale = BigInt(1) << (2 * n);
+    if (n <= 2 * decConversionThreshold * bitsInWord)
+        return divisionRemainder(scale, op).first;
+
+    size_t h = n / 2 + 1;
+    BigInt result = reciprocal(op >> (n - h)) << (n - h);
+    BigInt product = op * result;
+    if (product <= scale)
+        result += (result * (scale - product)) >> (2 * n);
+    else
+        result -= ((result * (product - scale)) >> (2 * n)) + 1;
+
+    product = op * result;
+    while (product > scale) {
+        result -= 1;
+        product -= op;
+    }
+    for (BigInt remainder = scale - product; remainder >= op; remainder -= op)
+        result += 1;
+    return result;
+}
+
+// 10^(decDigitsInWord * 2^i) and its reciprocal, both computed when first needed
+struct DecPower
+{
+    BigInt power;
+    std::optional<BigInt> reciprocal;
+};
+
+static DecPower& decPowerEntry(size_t i)
+{
+    thread_local std::vector<DecPower> powers;
+    if (powers.empty())
+        powers.push_back({BigInt(maxDecDivisibleWord), std::nullopt});
+    while (powers.size() <= i)
+        powers.push_back({square(powers.back().power), std::nullopt});
+    return powers[i];
+}
+
+static const BigInt& decPower(size_t i)
+{
+    return decPowerEntry(i).power;
+}
+
+// Barrett division by 10^(decDigitsInWord * 2^i), for op of at most twice its bits
+static std::pair<BigInt, BigInt> divideByDecPower(const BigInt& op, size_t i)
+{
+    DecPower& entry = decPowerEntry(i);
+    size_t n = entry.power.bitsLen();
+    if (op.bitsLen() > 2 * n)
+        return divisionRemainder(op, entry.power);
+    if (not entry.reciprocal)
+        entry.reciprocal = reciprocal(entry.power);
+
+    // The quotient estimate is at most 2 less than the real one
+    BigInt quotient = (op * *entry.reciprocal) >> (2 * n);
+    BigInt remainder = op - quotient * entry.power;
+    while (remainder >= entry.power) {
+        remainder -= entry.power;
+        quotient += 1;
+    }
+    return {std::move(quotient), std::move(remainder)};
+}
+
+static word parseDecChunk(const char* digits, size_t len)
+{
+    word result = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (digits[i] < '0' or digits[i] > '9')
+            throw std::invalid_argument("Invalid decimal digit");
+        result = result * 10 + static_cast<word>(digits[i] - '0');
+    }
+    return result;
+}
+
+// Value of the decimal digits [digits, digits + len). Long strings are split so that
+// the low part has decDigitsInWord * 2^i digits and joined as high * 10^(...) + low.
+static BigInt parseDec(const char* digits, size_t len)
+{
+    if (len <= decDigitsInWord * decConversionThreshold) {
+        LimbVector heap(1, 0);
+        size_t chunkLen = len % decDigitsInWord == 0 ? decDigitsInWord : len % decDigitsInWord;
+        for (size_t pos = 0; pos < len; pos += chunkLen, chunkLen = decDigitsInWord) {
+            // heap = heap * 10^decDigitsInWord + chunk
+            word carry = parseDecChunk(digits + pos, chunkLen);
+            for (word& limb : heap) {
+                word high;
+                word low = mulWide(limb, maxDecDivisibleWord, high);
+                word bit = 0;
+                limb = addCarry(low, carry, bit);
+                carry = high + bit;
+            }
+            if (carry != 0)
+                heap.push_back(carry);
+        }
+        return BigInt(std::move(heap));
+    }
+
+    size_t i = 0;
+    while ((decDigitsInWord << (i + 1)) < len)
+        ++i;
+    size_t lowLen = decDigitsInWord << i;
+    BigInt result = parseDec(digits, len - lowLen);
+    mul(result, result, decPower(i));
+    result += parseDec(digits + len - lowLen, lowLen);
+    return result;
+}
+
+// Passes the decimal digits of op to sink(const char*, size_t) from the most significant one,
+// padded with zeros to width digits. Without padding (width 0) zero is written as "0".
+// Long numbers are split by 10^(decDigitsInWord * 2^i) in a quotient and a remainder
+// written with exactly decDigitsInWord * 2^i digits, so no full string is ever built.
+template <typename Sink>
+static void writeDec(const BigInt& op, size_t width, Sink&& sink)
+{
+    if (op.wordLen() <= decConversionThreshold) {
+        char buffer[decBufferChunks * decDigitsInWord];
+        char* const end = buffer + sizeof(buffer);
+        char* first = end;
+        LimbVector numerator = op.getHeap();
+        size_t len = normalizedLen(numerator.data(), numerator.size());
+        while (len > 0) {
+            word chunk = divModWord(numerator.data(), numerator.data(), len, maxDecDivisibleWord);
+            len = normalizedLen(numerator.data(), len);
+            for (size_t i = 0; i < decDigitsInWord; ++i, chunk /= 10)
+                *--first = static_cast<char>('0' + chunk % 10);
+        }
+        while (first != end and *first == '0')
+            ++first;
+
+        size_t count = static_cast<size_t>(end - first);
+        if (width == 0 and count == 0)
+            width = 1;
+        static constexpr char zeros[] = "0000000000000000000000000000000000000000000000000000000000000000";
+        for (size_t padding = width > count ? width - count : 0; padding > 0;) {
+            size_t part = std::min(padding, sizeof(zeros) - 1);
+            sink(zeros, part);
+            padding -= part;
+        }
+        sink(first, count);
+        return;
+    }
+
+    // The width or an upper estimate of the digits count (log10(2) < 0.30103)
+    size_t digits = width != 0 ? width : op.bitsLen() * 30103 / 100000 + 1;
+    size_t i = 0;
+    while ((decDigitsInWord << (i + 1)) < digits)
+        ++i;
+    size_t lowLen = decDigitsInWord << i;
+    auto [quotient, remainder] = divideByDecPower(op, i);
+    if (width == 0 and quotient.isZero()) {
+        writeDec(remainder, 0, sink);
+        return;
+    }
+    writeDec(quotient, width != 0 ? width - lowLen : 0, sink);
+    writeDec(remainder, lowLen, sink);
+}
+
+// Digits of the top word without its leading zeros, then the other words in blocks
+// encoded straight from the limbs
+template <typename Sink>
+static void writePow2Digits(const BigInt& op, BigInt::Radix repr, Sink&& sink)
+{
+    constexpr size_t blockWords = 64;
+    char buffer[blockWords * bitsInWord];
+    const LimbVector& heap = op.getHeap();
+    auto encode = repr == BigInt::Hex ? encodeHexWords : encodeBinWords;
+    size_t digitsInWord = repr == BigInt::Hex ? hexDigitsInWord : bitsInWord;
+    size_t bitsPerDigit = repr == BigInt::Hex ? 4 : 1;
+
+    size_t topBits = std::max<size_t>(bitsInWord - countLeadingZeros(heap.back() | 1), 1);
+    size_t topDigits = (topBits + bitsPerDigit - 1) / bitsPerDigit;
+    encode(buffer, &heap.back(), 1);
+    sink(buffer + digitsInWord - topDigits, topDigits);
+
+    for (size_t end = heap.size() - 1; end > 0;) {
+        size_t count = std::min(end, blockWords);
+        encode(buffer, heap.data() + end - count, count);
+        sink(buffer, count * digitsInWord);
+        end -= count;
+    }
+}
+
+template <typename Sink>
+static void writeDigits(const BigInt& op, BigInt::Radix repr, Sink&& sink)
+{
+    if (repr == BigInt::Dec)
+        writeDec(op, 0, sink);
+    else
+        writePow2Digits(op, repr, sink);
+}
+
+BigInt::BigInt()
+    : _heap(1, 0)
+{
+}
 
-BigInt::BigInt(uint32_t value)
+BigInt::BigInt(word value)
 {
     _heap.clear();
     _heap.emplace_back(value);
 }
 
-BigInt::BigInt(size_t size, uint32_t value)
+BigInt::BigInt(size_t size, word value)
 {
     _heap.resize(size, value);
+    removeLeadingZeros();
 }
 
 BigInt::BigInt(const std::string& asStr, Radix base)
@@ -27,301 +245,261 @@ BigInt::BigInt(const std::string& asStr, Radix base)
 }
 
 BigInt::BigInt(std::vector<word>&& heap)
+    : _heap(heap.begin(), heap.end())
+{
+    removeLeadingZeros();
+}
+
+BigInt::BigInt(LimbVector&& heap)
+    : _heap(std::move(heap))
 {
-    _heap.insert(_heap.begin(), std::make_move_iterator(heap.begin()), std::make_move_iterator(heap.end()));
-    _table.clear();
     removeLeadingZeros();
 }
 
 void BigInt::setStr(const std::string &asStr, BigInt::Radix base)
 {
-    if (base == BigInt::Hex)
-        setHexStr(asStr);
-    else if (base == BigInt::Dec)
-        setDecStr(asStr);
-    else if (base == BigInt::Bin)
-        setBinStr(asStr);
+    auto [ptr, ec] = fromChars(asStr.data(), asStr.data() + asStr.size(), base);
+    if (ec != std::errc())
+        throw std::invalid_argument(fmt::format("Invalid digit at position {}", ptr - asStr.data()));
 }
 
 std::string BigInt::getStr(BigInt::Radix repr) const
 {
-    switch (repr) {
-    case Radix::Bin:
-        return getBinStr();
-    case Radix::Hex:
-        return getHexStr();
-    case Radix::Dec:
-        return getDecStr();
-    }
-    return getHexStr();
+    std::string result;
+    result.reserve(charsLen(repr));
+    writeDigits(*this, repr, [&result](const char* digits, size_t len) { result.append(digits, len); });
+    return result;
 }
 
-const std::vector<word>& BigInt::readHeap() const
+void BigInt::write(std::ostream& stream, BigInt::Radix repr) const
 {
-    return _heap;
+    writeDigits(*this, repr, [&stream](const char* digits, size_t len) {
+        stream.write(digits, static_cast<std::streamsize>(len));
+    });
 }
 
-void BigInt::operator<<=(const size_t numOfShifts)
+std::to_chars_result BigInt::toChars(char* first, char* last, BigInt::Radix repr) const
 {
-    for (size_t shiftIteration = 0; shiftIteration < numOfShifts; ++shiftIteration) {
-        word carryMask = 0;
-        for (size_t i = 0; i < _heap.size(); ++i) {
-            word newMask = ((~(~word(0) >> 1)) & _heap[i]) >> (bitsInWord - 1);
-            _heap[i] <<= 1;
-            _heap[i] |= carryMask;
-            carryMask = newMask;
-        }
-        if (carryMask)
-            _heap.emplace_back(1);
-    }
+    bool fits = true;
+    writeDigits(*this, repr, [&first, last, &fits](const char* digits, size_t len) {
+        if (fits and static_cast<size_t>(last - first) >= len)
+            first = std::copy(digits, digits + len, first);
+        else
+            fits = false;
+    });
+    if (not fits)
+        return {last, std::errc::value_too_large};
+    return {first, std::errc()};
 }
 
-BigInt BigInt::mAryLRExp(const BigInt& exponent)
+std::from_chars_result BigInt::fromChars(const char* first, const char* last, BigInt::Radix base)
 {
-    if (_table.empty())
-        generateExpTable();
-
-    if (*this == 0 and exponent == 0)
-        return 1;
-
-    if (*this < BigInt(2))
-        return *this;
-
-    std::vector<word> kAryWindows;
-    kAryWindows.reserve(std::ceil(exponent.bitsLen() / _expConstantK));
-    for (size_t i = 0; i < exponent.bitsLen(); i += _expConstantK)
-        kAryWindows.push_back(((exponent >> i) & (~(~word(0) << _expConstantK))).getHeap().front());
-    std::reverse(kAryWindows.begin(), kAryWindows.end());
+    size_t len = static_cast<size_t>(last - first);
+    if (base == Radix::Dec) {
+        const char* invalid = std::find_if(first, last, [](char digit) { return digit < '0' or digit > '9'; });
+        if (invalid != last)
+            return {invalid, std::errc::invalid_argument};
+        *this = parseDec(first, len);
+        return {last, std::errc()};
+    }
 
-    BigInt result = _table.at(kAryWindows.front());
+    if (base != Radix::Hex and base != Radix::Bin)
+        return {first, std::errc::invalid_argument};
 
-    for (size_t i = 1; i < kAryWindows.size(); ++i) {
-        for (size_t j = 0; j < _expConstantK; ++j)
-            result = result * result;
+    // Decoded aside, so the number is left unchanged by invalid input
+    size_t digitsInWord = base == Radix::Hex ? hexDigitsInWord : bitsInWord;
+    LimbVector heap(std::max((len + digitsInWord - 1) / digitsInWord, size_t(1)), 0);
+    const char* invalid = base == Radix::Hex ? decodeHexWords(heap.data(), first, len)
+                                             : decodeBinWords(heap.data(), first, len);
+    if (invalid != last)
+        return {invalid, std::errc::invalid_argument};
 
-        result = result * _table[kAryWindows[i]];
-    }
-    return result;
+    _heap = std::move(heap);
+    removeLeadingZeros();
+    return {last, std::errc()};
 }
 
-BigInt BigInt::binaryLRExp(const BigInt& exponent)
+size_t BigInt::charsLen(BigInt::Radix repr) const
 {
-    BigInt result = 1;
-    for (size_t i = exponent.bitsLen(); i > 0; --i) {
-        result = result * result;
-        if (exponent.getBitAt(i - 1) == true)
-            result = result * (*this);
+    size_t bits = std::max(bitsLen(), size_t(1));
+    switch (repr) {
+    case Radix::Bin:
+        return bits;
+    case Radix::Hex:
+        return (bits + 3) / 4;
+    case Radix::Dec:
+        return bits * 30103 / 100000 + 1;
     }
-    return result;
+    return 0;
 }
 
-BigInt BigInt::binaryRLExp(const BigInt& exponent)
+const LimbVector& BigInt::readHeap() const
 {
-    BigInt a = 1;
-    BigInt s = *this;
-    BigInt e = exponent;
-    while (not e.isZero()) {
-        if (e.getBitAt(0) == true)
-            a = a * s;
-        e = divisionRemainder(e, BigInt(2)).first;
-        if (not e.isZero())
-            s = s * s;
-    }
-    return a;
+    return _heap;
 }
 
-BigInt BigInt::binarySWExp(const BigInt& exponent)
+BigInt& BigInt::operator<<=(const size_t numOfShifts)
 {
-    if (_table.empty())
-        generateExpTable();
-
-    if (_heap.size() == 1 and exponent.wordLen() == 1)
-        return std::pow(_heap.front(), exponent.getHeap().front());
+    if (isZero())
+        return *this;
 
-    BigInt result = 1;
-    for (int32_t i = exponent.bitsLen() - 1; i >= 0;) {
-        if (exponent.getBitAt(i) == false) {
-           result = result * result;
-           --i;
-        } else {
-            word s = std::max(static_cast<int32_t>(i - _expConstantK + 1), 0);
-            while (exponent.getBitAt(s) == false)
-                ++s;
-
-            for (word h = 0; h < i - s + 1; ++h)
-                result = result * result;
-
-            BigInt tmp = (exponent >> s) & (~((~word(0)) << (i - s + 1)));
-            word u = tmp.getHeap().front();
-            result = result * _table.at(u);
-            i = s - 1;
-        }
-    }
-    return result;
+    size_t len = _heap.size();
+    _heap.resize(len + numOfShifts / bitsInWord + 1);
+    shiftLeftWords(_heap.data(), _heap.data(), len, numOfShifts);
+    removeLeadingZeros();
+    return *this;
 }
 
-void BigInt::generateExpTable()
+BigInt& BigInt::operator>>=(const size_t numOfShifts)
 {
-    _table.clear();
-    _table.resize((1 << _expConstantK));
-    _table[0] = 1;
-    for (size_t i = 1; i < (1 << _expConstantK); ++i)
-        _table[i] = (*this) * _table[i - 1];
+    size_t wordShift = numOfShifts / bitsInWord;
+    if (wordShift >= _heap.size()) {
+        _heap.assign(1, 0);
+        return *this;
+    }
+
+    shiftRightWords(_heap.data(), _heap.data(), _heap.size(), numOfShifts);
+    _heap.resize(_heap.size() - wordShift);
+    removeLeadingZeros();
+    return *this;
 }
 
-size_t BigInt::bitsLen() const
+BigInt& BigInt::operator+=(const BigInt& op)
 {
-    if (_heap.empty())
-        return 0;
+    if (this == &op)
+        return *this <<= 1;
 
-    size_t numberOfbits = (wordLen()) * bitsInWord;
+    size_t len = std::max(_heap.size(), op.wordLen());
+    _heap.resize(len + 1, 0);
+    _heap[len] = addWords(_heap.data(), _heap.data(), len, op.getHeap().data(), op.wordLen());
+    removeLeadingZeros();
+    return *this;
+}
 
-    word lastWord = _heap.back();
-    for (long i = _heap.size(); i > 1 and _heap[i - 1] == 0; --i) {
-        numberOfbits -= bitsInWord;
-        lastWord = _heap[i - 2];
-    }
+BigInt& BigInt::operator-=(const BigInt& op)
+{
+    if (*this < op)
+        throw std::logic_error("This library can not handle negative values (yet)");
 
-    for (size_t i = 0; i < bitsInWord and (lastWord & ~(~word(0) >> 1)) == 0; ++i) {
-        lastWord <<= 1;
-        --numberOfbits;
-    }
-    return numberOfbits;
+    size_t opLen = normalizedLen(op.getHeap().data(), op.wordLen());
+    subWords(_heap.data(), _heap.data(), _heap.size(), op.getHeap().data(), opLen);
+    removeLeadingZeros();
+    return *this;
 }
 
-bool BigInt::getBitAt(size_t index) const
+BigInt& BigInt::operator*=(const BigInt& op)
 {
-    if (index > bitsLen())
-        throw std::logic_error("Bad index");
-
-    auto wordNum = static_cast<size_t>(std::floor(index / bitsInWord));
-    size_t offset = index % bitsInWord;
+    mul(*this, *this, op);
+    return *this;
+}
 
-    return (_heap[wordNum] >> offset) & word(1);
+BigInt& BigInt::operator%=(const BigInt& modulo)
+{
+    *this = *this % modulo;
+    return *this;
 }
 
-void BigInt::setBitAt(size_t index, bool value)
+BigInt& BigInt::operator&=(const BigInt& op)
 {
-    if (index >= _heap.size() * bitsInWord)
-        _heap.resize(_heap.size() + std::ceil((index + 1) / bitsInWord));
+    size_t len = std::min(_heap.size(), op.wordLen());
+    _heap.resize(len);
+    for (size_t i = 0; i < len; ++i)
+        _heap[i] &= op.getHeap()[i];
+    removeLeadingZeros();
+    return *this;
+}
 
-    auto wordNum = static_cast<size_t>(std::floor(index / bitsInWord));
-    size_t offset = index % bitsInWord;
-    if (value) {
-        word mask = word(1) << offset;
-        _heap[wordNum] |= mask;
-    } else {
-        word mask = ~(word(1) << offset);
-        _heap[wordNum] &= mask;
-    }
+BigInt& BigInt::operator|=(const BigInt& op)
+{
+    _heap.resize(std::max(_heap.size(), op.wordLen()), 0);
+    for (size_t i = 0; i < op.wordLen(); ++i)
+        _heap[i] |= op.getHeap()[i];
+    return *this;
 }
 
-word BigInt::getExpConstantK() const
+BigInt& BigInt::operator^=(const BigInt& op)
 {
-    return _expConstantK;
+    _heap.resize(std::max(_heap.size(), op.wordLen()), 0);
+    for (size_t i = 0; i < op.wordLen(); ++i)
+        _heap[i] ^= op.getHeap()[i];
+    removeLeadingZeros();
+    return *this;
 }
 
-void BigInt::setExpConstantK(const word& expConstantK)
+BigInt BigInt::mAryLRExp(const BigInt& exponent, word k) const
 {
-    _expConstantK = expConstantK;
+    if (*this == 0 and exponent == 0)
+        return 1;
+
+    if (*this < BigInt(2))
+        return *this;
+
+    if (k == adaptiveExpWindowK)
+        k = expWindowK(exponent.bitsLen(), wordLen(), ExpWindowMethod::MAry);
+    return ExpTable(*this, k).mAryLRExp(exponent);
 }
 
-std::string BigInt::getDecStr() const
+BigInt BigInt::binaryLRExp(const BigInt& exponent) const
 {
-    std::string result;
-    constexpr word maxDecDivisibleWord = 1000000000;
-    BigInt base(1, maxDecDivisibleWord);
-    BigInt numerator = *this;
-    std::vector<std::string> parts;
-    parts.reserve(_heap.size());
-
-    std::pair<BigInt, BigInt> quotientRemainder;
-    for (size_t i = 0; numerator >= base; ++i) {
-        quotientRemainder = divisionRemainder(numerator, base);
-        parts.emplace_back(fmt::format("{:0>9d}", quotientRemainder.second.getHeap().front()));
-        numerator = quotientRemainder.first;
+    BigInt result = 1;
+    for (size_t i = exponent.bitsLen(); i > 0; --i) {
+        sqr(result, result);
+        if (exponent.getBitAt(i - 1) == true)
+            mul(result, result, *this);
     }
-    quotientRemainder = divisionRemainder(numerator, base);
-    parts.emplace_back(fmt::format("{0:d}", quotientRemainder.second.getHeap().front()));
-    std::reverse(parts.begin(), parts.end());
-    for (const std::string &part : parts)
-        result += part;
-
     return result;
 }
 
-std::string BigInt::getHexStr() const
+BigInt BigInt::binaryRLExp(const BigInt& exponent) const
 {
-    std::string result;
-    result += fmt::format("{0:x}", _heap.back());
-    for (auto it = _heap.rbegin() + 1; it != _heap.rend(); ++it)
-        result += fmt::format("{:0>8x}", *it);
-    return result;
+    BigInt a = 1;
+    BigInt s = *this;
+    BigInt e = exponent;
+    while (not e.isZero()) {
+        if (e.getBitAt(0) == true)
+            mul(a, a, s);
+        e >>= 1;
+        if (not e.isZero())
+            sqr(s, s);
+    }
+    return a;
 }
 
-std::string BigInt::getBinStr() const
+BigInt BigInt::binarySWExp(const BigInt& exponent, word k) const
 {
-    std::string result;
-    result += fmt::format("{0:b}", _heap.back());
-    for (auto it = _heap.rbegin() + 1; it != _heap.rend(); ++it)
-        result += fmt::format("{:0>32b}", *it);
-    return result;
+    if (k == adaptiveExpWindowK)
+        k = expWindowK(exponent.bitsLen(), wordLen());
+    return ExpTable(*this, k).slidingWindowExp(exponent);
 }
 
-void BigInt::setHexStr(const std::string& asStr)
+size_t BigInt::bitsLen() const
 {
-    _heap.clear();
-    // Add leading 0 digits if any needed
-    std::string trailingNulls;
-    constexpr size_t digitsBase = 8;
-    for (size_t i = 0; i < (digitsBase - asStr.size() % digitsBase) % digitsBase; ++i)
-        trailingNulls += '0';
-
-    std::string formattedStr = trailingNulls + asStr;
-    size_t heapSize = static_cast<size_t>(formattedStr.size() / digitsBase);
-    _heap.resize(heapSize);
-    for (size_t i = 0, j = heapSize - 1; i < formattedStr.size(); i += digitsBase, --j)
-        _heap[j] = static_cast<word>(stoul(formattedStr.substr(i, digitsBase), nullptr, 16));
+    if (_heap.empty() or isZero())
+        return 0;
 
-    removeLeadingZeros();
+    return _heap.size() * bitsInWord - countLeadingZeros(_heap.back());
 }
 
-void BigInt::setDecStr(const std::string& asStr)
+bool BigInt::getBitAt(size_t index) const
 {
-    _heap.clear();
-    std::string trailingNulls;
-    constexpr int32_t digitsBase = 8;
-    for (size_t i = 0; i < (digitsBase - asStr.size() % digitsBase) % digitsBase; ++i)
-        trailingNulls += '0';
-
-    std::string formattedStr = trailingNulls + asStr;
-    for (int32_t i = formattedStr.size() - 1, j = 0; i - digitsBase + 1 >= 0; i -= digitsBase, j += digitsBase) {
-        BigInt multiplier = BigInt(10).binarySWExp(j);
-        std::string subs = formattedStr.substr(i - digitsBase + 1, digitsBase);
-        auto foo = static_cast<word>(stoul(subs, nullptr, 10));
-        *this = *this + (foo * multiplier);
-    }
+    if (index > bitsLen())
+        throw std::logic_error("Bad index");
+
+    size_t wordNum = index / bitsInWord;
+    return wordNum < _heap.size() and ((_heap[wordNum] >> (index % bitsInWord)) & word(1));
 }
 
-void BigInt::setBinStr(const std::string& asStr)
+void BigInt::setBitAt(size_t index, bool value)
 {
-    _heap.clear();
-    // Add leading 0 digits if any needed
-    std::string trailingNulls;
-    constexpr size_t digitsBase = 32;
-    for (size_t i = 0; i < (digitsBase - asStr.size() % digitsBase) % digitsBase; ++i)
-        trailingNulls += '0';
-
-    std::string formattedStr = trailingNulls + asStr;
-    size_t heapSize = static_cast<size_t>(formattedStr.size() / digitsBase);
-    _heap.resize(heapSize);
-    for (size_t i = 0, j = heapSize - 1; i < formattedStr.size(); i += digitsBase, --j) {
-        try {
-            _heap[j] = static_cast<word>(stoul(formattedStr.substr(i, digitsBase), nullptr, 2));
-        } catch (std::exception &err) {
-            std::cerr << err.what() << std::endl;
-        }
+    size_t wordNum = index / bitsInWord;
+    word mask = word(1) << (index % bitsInWord);
+    if (value) {
+        if (wordNum >= _heap.size())
+            _heap.resize(wordNum + 1, 0);
+        _heap[wordNum] |= mask;
+    } else if (wordNum < _heap.size()) {
+        _heap[wordNum] &= ~mask;
+        removeLeadingZeros();
     }
-
-    removeLeadingZeros();
 }
+
@@ -1,16 +1,47 @@
 #ifndef BIGINT_H
 #define BIGINT_H
 
+#include <algorithm>
+#include <charconv>
 #include <vector>
+#include "limbvector.h"
 #include <string>
 #include <cstdint>
 
 #include <iostream>
 
+// Limb width is a build-time parameter. 64-bit limbs need a 128-bit type for the
+// full word products, so default to them only where the compiler provides one.
+#ifndef BIGINT_WORD_BITS
+#ifdef __SIZEOF_INT128__
+#define BIGINT_WORD_BITS 64
+#else
+#define BIGINT_WORD_BITS 32
+#endif
+#endif
+
+#if BIGINT_WORD_BITS == 64
+using word = uint64_t;
+// Double-width type holding full word products and carries
+using dword = unsigned __int128;
+#elif BIGINT_WORD_BITS == 32
 using word = uint32_t;
-constexpr size_t bitsInWord = 32;
+using dword = uint64_t;
+#else
+#error "BIGINT_WORD_BITS must be either 32 or 64"
+#endif
+
+constexpr size_t bitsInWord = BIGINT_WORD_BITS;
 constexpr word maxWord = ~word(0);
 
+// Numbers up to 256 bits live inside the BigInt object without any allocation,
+// the extra word keeps the carry of additions and shifts of such numbers inline too
+using LimbVector = SmallLimbVector<word, 256 / bitsInWord + 1>;
+
+// Window width argument of the m-ary and sliding window exponentiation that picks k
+// from the exponent length (see expWindowK in expschedule.h)
+constexpr word adaptiveExpWindowK = 0;
+
 class BigInt
 {
 public:
@@ -21,32 +52,80 @@ public:
         Bin = 2
     };
 
-    BigInt() = default;
+    // Zero
+    BigInt();
     BigInt(word value);
     BigInt(size_t size, word value);
     BigInt(const std::string& asStr, Radix base = Hex);
     BigInt(std::vector<word>&& heap);
+    BigInt(LimbVector&& heap);
     BigInt(const BigInt& left) = default;
+    // A moved-from number is zero, the heap is never left without words
+    BigInt(BigInt&& left) noexcept
+        : _heap(std::move(left._heap))
+    {
+        left._heap.assign(1, 0);
+    }
+    BigInt& operator=(const BigInt& right) = default;
+    BigInt& operator=(BigInt&& right) noexcept
+    {
+        if (this != &right) {
+            _heap = std::move(right._heap);
+            right._heap.assign(1, 0);
+        }
+        return *this;
+    }
 
     void setStr(const std::string& asStr, Radix base = Radix::Hex);
     std::string getStr(Radix repr = Radix::Hex) const;
-    const std::vector<word>& readHeap() const;
-
-    // As this operator can make heap bigger, reallocation costs may become significant.
-    // So by introducing this in-place operation we ommit reallocations where it is possible.
-    // TODO: intoduce more binary in-place operators like this.
-    void operator<<=(const size_t numOfShifts);
+    // Same digits as getStr, streamed without building the whole string
+    void write(std::ostream& stream, Radix repr = Radix::Hex) const;
+    // Conversions in the manner of std::to_chars/std::from_chars. Hexadecimal and binary digits
+    // need no allocations besides the limbs of the number itself and throw nothing. Decimal
+    // numbers above 32 words are split by powers of ten into temporary numbers, which allocate
+    // and may throw std::bad_alloc. Invalid digits give std::errc::invalid_argument
+    // (and leave the number unchanged), a too short buffer std::errc::value_too_large.
+    // An empty range reads as zero, hexadecimal digits are accepted in any case.
+    std::to_chars_result toChars(char* first, char* last, Radix repr = Radix::Hex) const;
+    std::from_chars_result fromChars(const char* first, const char* last, Radix base = Radix::Hex);
+    // Exact number of binary and hexadecimal digits, an upper bound for the decimal ones
+    size_t charsLen(Radix repr = Radix::Hex) const;
+    const LimbVector& readHeap() const;
+
+    // In-place operations work on the existing heap and reuse its capacity,
+    // so once the heap is big enough they do not allocate at all
+    BigInt& operator<<=(const size_t numOfShifts);
+    BigInt& operator>>=(const size_t numOfShifts);
+    BigInt& operator+=(const BigInt& op);
+    BigInt& operator-=(const BigInt& op);
+    BigInt& operator*=(const BigInt& op);
+    BigInt& operator%=(const BigInt& modulo);
+    BigInt& operator&=(const BigInt& op);
+    BigInt& operator|=(const BigInt& op);
+    BigInt& operator^=(const BigInt& op);
+
+    // Overwrites the number with len words written by fill(word*), reusing the heap capacity.
+    // The heap may move before the call, so fill must not read this number.
+    template <typename Fill>
+    void assignWords(size_t len, Fill&& fill)
+    {
+        _heap.resize(std::max(len, size_t(1)), 0);
+        fill(_heap.data());
+        removeLeadingZeros();
+    }
 
-    BigInt mAryLRExp(const BigInt& exponent);
-    BigInt binaryLRExp(const BigInt& exponent);
-    BigInt binaryRLExp(const BigInt& exponent);
-    BigInt binarySWExp(const BigInt& exponent);
-    void generateExpTable();
+    // The window methods build a table of powers for every call, keep an ExpTable
+    // (exptable.h) to reuse it for many exponents of the same base
+    BigInt mAryLRExp(const BigInt& exponent, word k = adaptiveExpWindowK) const;
+    BigInt binaryLRExp(const BigInt& exponent) const;
+    BigInt binaryRLExp(const BigInt& exponent) const;
+    BigInt binarySWExp(const BigInt& exponent, word k = adaptiveExpWindowK) const;
 
     size_t bitsLen() const;
     bool getBitAt(size_t index) const;
     void setBitAt(size_t index, bool value);
 
+    // Number of significant words, the heap never has leading zero words
     inline size_t wordLen() const
     {
         return _heap.size();
@@ -57,39 +136,32 @@ public:
         return _heap.size() == 1 and _heap.front() == 0;
     }
 
+    // Keeps the low newSize words at most, growing adds nothing but leading zeros
     inline void resize(size_t newSize)
     {
-        _heap.resize(newSize, 0);
+        if (newSize < _heap.size()) {
+            _heap.resize(newSize);
+            removeLeadingZeros();
+        }
     }
 
-    inline const std::vector<word> &getHeap() const
+    inline const LimbVector& getHeap() const
     {
         return _heap;
     }
 
+private:
+    // Restores the invariant after the heap was changed: no leading zero words,
+    // zero is a single zero word
     inline void removeLeadingZeros()
     {
         size_t newSize = _heap.size();
-        for (size_t i = _heap.size() - 1; i > 0 and _heap[i] == 0; --i)
+        while (newSize > 1 and _heap[newSize - 1] == 0)
             --newSize;
-        _heap.resize(newSize);
+        _heap.resize(std::max(newSize, size_t(1)), 0);
     }
 
-    word getExpConstantK() const;
-    void setExpConstantK(const word& expConstantK);
-
-private:
-    std::string getDecStr() const;
-    std::string getHexStr() const;
-    std::string getBinStr() const;
-    void setHexStr(const std::string& asStr);
-    void setDecStr(const std::string& asStr);
-    void setBinStr(const std::string& asStr);
-
-
-    std::vector<BigInt> _table;
-    word _expConstantK = 3;
-    std::vector<word> _heap;
+    LimbVector _heap;
 };
 
 #endif // BIGINT_H
@@ -0,0 +1,214 @@
+#include "bigintcodec.h"
+
+#include <cstring>
+
+// The SSSE3 functions are compiled for it whatever the flags of the build and chosen at run time
+// when the processor has it. BIGINT_NO_SSSE3 (the BIGINT_SSSE3 CMake option) leaves them out.
+#if (defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))) && !defined(BIGINT_NO_SSSE3)
+#include <immintrin.h>
+#define BIGINT_HAS_SSSE3_CODEC
+#define BIGINT_SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+
+namespace {
+
+constexpr unsigned char invalidDigit = 0xff;
+
+struct CodecTables
+{
+    char hexPairs[256][2];
+    char binOctets[256][8];
+    unsigned char hexValues[256];
+};
+
+constexpr CodecTables makeCodecTables()
+{
+    constexpr char hexDigits[] = "0123456789abcdef";
+    CodecTables tables = {};
+    for (size_t byte = 0; byte < 256; ++byte) {
+        tables.hexPairs[byte][0] = hexDigits[byte >> 4];
+        tables.hexPairs[byte][1] = hexDigits[byte & 0xf];
+        for (size_t bit = 0; bit < 8; ++bit)
+            tables.binOctets[byte][bit] = (byte >> (7 - bit)) & 1 ? '1' : '0';
+        tables.hexValues[byte] = invalidDigit;
+    }
+    for (unsigned char i = 0; i < 16; ++i) {
+        tables.hexValues[static_cast<unsigned char>(hexDigits[i])] = i;
+        if (i >= 10)
+            tables.hexValues[static_cast<unsigned char>(hexDigits[i] - 'a' + 'A')] = i;
+    }
+    return tables;
+}
+
+constexpr CodecTables codecTables = makeCodecTables();
+
+#ifdef BIGINT_HAS_SSSE3_CODEC
+word byteSwap(word op)
+{
+    if constexpr (bitsInWord == 64)
+        return static_cast<word>(__builtin_bswap64(op));
+    else
+        return static_cast<word>(__builtin_bswap32(op));
+}
+
+bool hasSsse3()
+{
+#ifdef __SSSE3__
+    return true;
+#else
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+#endif
+}
+
+// The bytes of op, most significant first, split into nibbles and looked up in one shuffle
+BIGINT_SSSE3_TARGET void encodeHexWordSsse3(char* result, word op)
+{
+    const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                         '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m128i lowNibbles = _mm_set1_epi8(0x0f);
+    __m128i bytes = _mm_cvtsi64_si128(static_cast<long long>(byteSwap(op)));
+    __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), lowNibbles);
+    __m128i low = _mm_and_si128(bytes, lowNibbles);
+    __m128i chars = _mm_shuffle_epi8(digits, _mm_unpacklo_epi8(high, low));
+    if constexpr (bitsInWord == 64)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(result), chars);
+    else
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(result), chars);
+}
+
+// Decodes hexDigitsInWord digits, returns false if any of them is invalid
+BIGINT_SSSE3_TARGET bool decodeHexWordSsse3(word& result, const char* digits)
+{
+    __m128i chars = bitsInWord == 64 ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits))
+                                     : _mm_loadl_epi64(reinterpret_cast<const __m128i*>(digits));
+    // Digits map to 0..9, letters of any case to 0..5, everything else outside of these ranges
+    __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    constexpr int usedLanes = (1 << hexDigitsInWord) - 1;
+    if ((_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) & usedLanes) != usedLanes)
+        return false;
+
+    __m128i values = _mm_or_si128(_mm_and_si128(isDigit, digit),
+                                  _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+    // 16 * high + low for every pair, then the bytes back to the limb order
+    __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110));
+    __m128i bytes = _mm_packus_epi16(pairs, pairs);
+    result = byteSwap(static_cast<word>(_mm_cvtsi128_si64(bytes)));
+    return true;
+}
+
+BIGINT_SSSE3_TARGET void encodeHexWordsSsse3(char* result, const word* op, size_t len)
+{
+    for (size_t i = len; i > 0; --i, result += hexDigitsInWord)
+        encodeHexWordSsse3(result, op[i - 1]);
+}
+
+// Decodes the full words from the top one down to the first one with an invalid digit,
+// returns the number of words left undecoded
+BIGINT_SSSE3_TARGET size_t decodeHexWordsSsse3(word* result, const char* digits, size_t len, size_t fullWords)
+{
+    for (; fullWords > 0; --fullWords) {
+        if (not decodeHexWordSsse3(result[fullWords - 1], digits + len - fullWords * hexDigitsInWord))
+            break;
+    }
+    return fullWords;
+}
+#endif
+
+// Digits [digits, digits + len) of a single word, len is at most hexDigitsInWord
+const char* decodeHexWord(word& result, const char* digits, size_t len)
+{
+    result = 0;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char value = codecTables.hexValues[static_cast<unsigned char>(digits[i])];
+        if (value == invalidDigit)
+            return digits + i;
+        result = (result << 4) | value;
+    }
+    return digits + len;
+}
+
+const char* decodeBinWord(word& result, const char* digits, size_t len)
+{
+    result = 0;
+    for (size_t i = 0; i < len; ++i) {
+        word bit = static_cast<word>(digits[i] ^ '0');
+        if (bit > 1)
+            return digits + i;
+        result = (result << 1) | bit;
+    }
+    return digits + len;
+}
+
+} // namespace
+
+void encodeHexWords(char* result, const word* op, size_t len)
+{
+#ifdef BIGINT_HAS_SSSE3_CODEC
+    if (hasSsse3()) {
+        encodeHexWordsSsse3(result, op, len);
+        return;
+    }
+#endif
+    for (size_t i = len; i > 0; --i, result += hexDigitsInWord) {
+        char* pair = result;
+        for (size_t byte = sizeof(word); byte > 0; --byte, pair += 2)
+            std::memcpy(pair, codecTables.hexPairs[(op[i - 1] >> (8 * (byte - 1))) & 0xff], 2);
+    }
+}
+
+void encodeBinWords(char* result, const word* op, size_t len)
+{
+    for (size_t i = len; i > 0; --i) {
+        for (size_t byte = sizeof(word); byte > 0; --byte, result += 8)
+            std::memcpy(result, codecTables.binOctets[(op[i - 1] >> (8 * (byte - 1))) & 0xff], 8);
+    }
+}
+
+const char* decodeHexWords(word* result, const char* digits, size_t len)
+{
+    // The top word may be shorter, the others take hexDigitsInWord digits each.
+    // Digits are read from the left, so the first invalid one is found.
+    size_t fullWords = len / hexDigitsInWord;
+    size_t topDigits = len % hexDigitsInWord;
+    if (topDigits != 0) {
+        const char* invalid = decodeHexWord(result[fullWords], digits, topDigits);
+        if (invalid != digits + topDigits)
+            return invalid;
+    }
+
+#ifdef BIGINT_HAS_SSSE3_CODEC
+    // The word with an invalid digit and the ones below it are left to the tables
+    if (hasSsse3())
+        fullWords = decodeHexWordsSsse3(result, digits, len, fullWords);
+#endif
+    for (size_t i = fullWords; i > 0; --i) {
+        const char* wordDigits = digits + len - i * hexDigitsInWord;
+        const char* invalid = decodeHexWord(result[i - 1], wordDigits, hexDigitsInWord);
+        if (invalid != wordDigits + hexDigitsInWord)
+            return invalid;
+    }
+    return digits + len;
+}
+
+const char* decodeBinWords(word* result, const char* digits, size_t len)
+{
+    size_t fullWords = len / bitsInWord;
+    size_t topDigits = len % bitsInWord;
+    if (topDigits != 0) {
+        const char* invalid = decodeBinWord(result[fullWords], digits, topDigits);
+        if (invalid != digits + topDigits)
+            return invalid;
+    }
+
+    for (size_t i = fullWords; i > 0; --i) {
+        const char* wordDigits = digits + len - i * bitsInWord;
+        const char* invalid = decodeBinWord(result[i - 1], wordDigits, bitsInWord);
+        if (invalid != wordDigits + bitsInWord)
+            return invalid;
+    }
+    return digits + len;
+}
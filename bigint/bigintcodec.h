@@ -0,0 +1,25 @@
+#ifndef BIGINTCODEC_H
+#define BIGINTCODEC_H
+
+#include "bigint.h"
+
+// Hexadecimal and binary digits of limb arrays through direct lookup tables.
+// Digits go most significant first, hexadecimal ones are written in lowercase
+// and read in any case. Nothing is allocated, the caller provides the buffers.
+// On x86-64 processors with SSSE3 whole limbs of hexadecimal digits are converted
+// at once with byte shuffles, the check is done at run time.
+
+constexpr size_t hexDigitsInWord = bitsInWord / 4;
+
+// Writes exactly hexDigitsInWord * len digits of op, leading zeros included
+void encodeHexWords(char* result, const word* op, size_t len);
+// Writes exactly bitsInWord * len digits of op, leading zeros included
+void encodeBinWords(char* result, const word* op, size_t len);
+
+// Both read len digits into (len + digitsInWord - 1) / digitsInWord words and return
+// the first invalid character, digits + len when every digit is valid.
+// The result is unspecified if a digit is invalid.
+const char* decodeHexWords(word* result, const char* digits, size_t len);
+const char* decodeBinWords(word* result, const char* digits, size_t len);
+
+#endif // BIGINTCODEC_H
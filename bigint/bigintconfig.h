@@ -0,0 +1,34 @@
+#ifndef BIGINTCONFIG_H
+#define BIGINTCONFIG_H
+
+// Multiplication crossovers, in words of the shorter operand. Below the Karatsuba
+// threshold schoolbook multiplication is used, from the Toom-3 one on Toom-Cook 3-way.
+// The defaults suit a typical x86-64 host. Run tune-exponentiation to measure them
+// for the build host and to regenerate this header.
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#if BIGINT_WORD_BITS == 64
+#define BIGINT_KARATSUBA_THRESHOLD 32
+#else
+#define BIGINT_KARATSUBA_THRESHOLD 40
+#endif
+#endif
+
+#ifndef BIGINT_TOOM3_THRESHOLD
+#if BIGINT_WORD_BITS == 64
+#define BIGINT_TOOM3_THRESHOLD 192
+#else
+#define BIGINT_TOOM3_THRESHOLD 160
+#endif
+#endif
+
+// Cost of a squaring in percent of the cost of a multiplication at 1, 4, 16, 64 and
+// 256 words, the cost model of the exponentiation window size uses it
+#ifndef BIGINT_SQR_COST_PERCENT
+#if BIGINT_WORD_BITS == 64
+#define BIGINT_SQR_COST_PERCENT 90, 80, 55, 55, 55
+#else
+#define BIGINT_SQR_COST_PERCENT 90, 85, 55, 50, 50
+#endif
+#endif
+
+#endif // BIGINTCONFIG_H
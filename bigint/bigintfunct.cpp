@@ -1,33 +1,20 @@
 
 #include "bigintfunct.h"
+#include "bigintkernel.h"
+#include "modcontext.h"
 
 #include <cmath>
 
 BigInt operator+(const BigInt& left, const BigInt& right)
 {
-    bool carry = false;
-    BigInt result(std::max(left.wordLen(), right.wordLen()) + 1, 0);
-    for (size_t i = 0; i < std::min(left.bitsLen(), right.bitsLen()); ++i) {
-        bool leftBit = left.getBitAt(i);
-        bool rightBit = right.getBitAt(i);
-        result.setBitAt(i, leftBit ^ rightBit ^ carry);
-        carry = (leftBit & rightBit) | (leftBit & carry) | (rightBit & carry);
-    }
-    for (size_t i = std::min(left.bitsLen(), right.bitsLen()); i < left.bitsLen(); ++i) {
-        bool leftBit = left.getBitAt(i);
-        result.setBitAt(i, leftBit ^ carry);
-        carry &= leftBit;
-    }
-    for (size_t i = std::min(left.bitsLen(), right.bitsLen()); i < right.bitsLen(); ++i) {
-        bool rightBit = right.getBitAt(i);
-        result.setBitAt(i, rightBit ^ carry);
-        carry &= rightBit;
-    }
-    result.bitsLen();
-    result.setBitAt(std::max(left.bitsLen(), right.bitsLen()), carry);
+    const BigInt& longer = left.wordLen() >= right.wordLen() ? left : right;
+    const BigInt& shorter = left.wordLen() >= right.wordLen() ? right : left;
 
-    result.removeLeadingZeros();
-    return result;
+    LimbVector resultHeap(longer.wordLen() + 1, 0);
+    resultHeap.back() = addWords(resultHeap.data(),
+                                 longer.getHeap().data(), longer.wordLen(),
+                                 shorter.getHeap().data(), shorter.wordLen());
+    return BigInt(std::move(resultHeap));
 }
 
 BigInt operator-(const BigInt& left, const BigInt& right)
@@ -38,41 +25,76 @@ BigInt operator-(const BigInt& left, const BigInt& right)
     if (left == right)
         return 0;
 
-    bool carry = false;
-    BigInt result(std::max(left.wordLen(), right.wordLen()) + 1, 0);
-    for (size_t i = 0; i < std::min(left.bitsLen(), right.bitsLen()); ++i) {
-        bool leftBit = left.getBitAt(i);
-        bool rightBit = right.getBitAt(i);
-        result.setBitAt(i, leftBit ^ rightBit ^ carry);
-        carry = (!leftBit & rightBit) | (!leftBit & carry) | (leftBit & rightBit & carry);
+    // left > right here, so right can not have more significant words than left
+    size_t leftLen = normalizedLen(left.getHeap().data(), left.wordLen());
+    size_t rightLen = normalizedLen(right.getHeap().data(), right.wordLen());
+    LimbVector resultHeap(leftLen, 0);
+    subWords(resultHeap.data(), left.getHeap().data(), leftLen, right.getHeap().data(), rightLen);
+    return BigInt(std::move(resultHeap));
+}
+
+BigInt operator*(const BigInt& left, const BigInt& right)
+{
+    BigInt result;
+    mul(result, left, right);
+    return result;
+}
+
+BigInt square(const BigInt& op)
+{
+    BigInt result;
+    sqr(result, op);
+    return result;
+}
+
+// Writes len words produced by fill into result. When result is also an operand
+// the words go through a per-thread buffer first, so the operand stays intact.
+template <typename Fill>
+static void assignProduct(BigInt& result, bool aliased, size_t len, Fill&& fill)
+{
+    if (not aliased) {
+        result.assignWords(len, fill);
+        return;
     }
-    for (size_t i = std::min(left.bitsLen(), right.bitsLen()); i < left.bitsLen(); ++i) {
-        bool leftBit = left.getBitAt(i);
-        result.setBitAt(i, leftBit ^ carry);
-        carry &= !leftBit;
+
+    static thread_local std::vector<word> product;
+    product.resize(len);
+    fill(product.data());
+    result.assignWords(len, [](word* heap) { std::copy(product.begin(), product.end(), heap); });
+}
+
+void mul(BigInt& result, const BigInt& left, const BigInt& right)
+{
+    size_t leftLen = normalizedLen(left.getHeap().data(), left.wordLen());
+    size_t rightLen = normalizedLen(right.getHeap().data(), right.wordLen());
+    if (leftLen == 0 or rightLen == 0) {
+        result.assignWords(1, [](word* heap) { heap[0] = 0; });
+        return;
     }
 
-    result.removeLeadingZeros();
-    return result;
+    const word* leftHeap = left.getHeap().data();
+    const word* rightHeap = right.getHeap().data();
+    if (leftLen < rightLen) {
+        std::swap(leftHeap, rightHeap);
+        std::swap(leftLen, rightLen);
+    }
+    assignProduct(result, &result == &left or &result == &right, leftLen + rightLen, [&](word* heap) {
+        mulWords(heap, leftHeap, leftLen, rightHeap, rightLen);
+    });
 }
 
-BigInt operator*(const BigInt& left, const BigInt& right)
+void sqr(BigInt& result, const BigInt& op)
 {
-    constexpr word max16bitWord = (1 << 16) - 1;
-    if ((left <= max16bitWord) and (right <= max16bitWord))
-        return BigInt(1, left.getHeap().front() * right.getHeap().front());
-
-    size_t n = std::floor(std::max(left.bitsLen(), right.bitsLen()) / 2);
-    const BigInt mask = (BigInt(1) << n) - 1;
-    BigInt leftHigh = left >> n;
-    BigInt leftLow = left & mask;
-    BigInt rightHigh = right >> n;
-    BigInt rightLow = right & mask;
-
-    BigInt highPord = leftHigh * rightHigh;
-    BigInt lowProd = leftLow * rightLow;
-    BigInt crossProd = ((leftHigh + leftLow) * (rightHigh + rightLow)) - highPord - lowProd;
-    return (((highPord << n) + crossProd) << n) + lowProd;
+    size_t len = normalizedLen(op.getHeap().data(), op.wordLen());
+    if (len == 0) {
+        result.assignWords(1, [](word* heap) { heap[0] = 0; });
+        return;
+    }
+
+    const word* heap = op.getHeap().data();
+    assignProduct(result, &result == &op, 2 * len, [&](word* resultHeap) {
+        sqrWords(resultHeap, heap, len);
+    });
 }
 
 BigInt operator%(const BigInt& op, const BigInt& modulo)
@@ -86,93 +108,69 @@ BigInt operator%(const BigInt& op, const BigInt& modulo)
     if (op < maxWord and modulo < maxWord)
         return op.getHeap()[0] % modulo.getHeap()[0];
 
-    BigInt remainder = 0;
-    BigInt bPowerT = BigInt(1) << modulo.bitsLen();
-    BigInt c = bPowerT - modulo;
-    auto[q0, r0] = divisionRemainder(op, bPowerT);
-    BigInt q1;
-    remainder = r0;
-    BigInt r1;
-    for (size_t i = 0; q0 > 0; ++i) {
-        q1 = divisionRemainder(q0 * c, bPowerT).first;
-        r1 = q0 * c  - q1 * bPowerT;
-        remainder = remainder + r1;
-        q0 = q1;
-    }
-    while (remainder >= modulo)
-        remainder = remainder - modulo;
-
-    return remainder;
+    // One-off reduction. Reducing many values against the same modulo should go
+    // through ModContext which precomputes everything modulo-dependent once.
+    return divisionRemainder(op, modulo).second;
 }
 
 std::pair<BigInt, BigInt> divisionRemainder(const BigInt& numerator, const BigInt& denominator)
 {
-    if (denominator.isZero())
+    size_t numLen = normalizedLen(numerator.getHeap().data(), numerator.wordLen());
+    size_t denLen = normalizedLen(denominator.getHeap().data(), denominator.wordLen());
+    if (denLen == 0)
         throw std::logic_error("Division by zero is impossible");
 
-    if ((numerator <= BigInt(1, maxWord)) and (denominator <= BigInt(1, maxWord))) {
-        auto quotient = static_cast<word>(numerator.getHeap().front() / denominator.getHeap().front());
-        word remainder = numerator.getHeap().front() % denominator.getHeap().front();
-        return {quotient, remainder};
-    }
+    if (numLen < denLen)
+        return {0, numLen == 0 ? BigInt(0) : numerator};
 
-    BigInt quotient = 0;
-    BigInt remainder = 0;
-    for (long i = numerator.bitsLen() - 1; i >= 0; --i) {
-        remainder = remainder << 1;
-        remainder.setBitAt(0, numerator.getBitAt(i));
-        if (remainder >= denominator) {
-            remainder = remainder - denominator;
-            quotient.setBitAt(i, true);
-        }
-    }
-    quotient.removeLeadingZeros();
-    remainder.removeLeadingZeros();
-    return {quotient, remainder};
+    LimbVector quotient(numLen - denLen + 1);
+    LimbVector remainder(denLen);
+    divModWords(quotient.data(), remainder.data(), numerator.getHeap().data(), numLen,
+                denominator.getHeap().data(), denLen);
+    return {BigInt(std::move(quotient)), BigInt(std::move(remainder))};
+}
+
+int compare(const BigInt& left, const BigInt& right)
+{
+    // Heaps are normalized, so the longer one holds the bigger number
+    if (left.wordLen() != right.wordLen())
+        return left.wordLen() < right.wordLen() ? -1 : 1;
+    return compareWords(left.getHeap().data(), right.getHeap().data(), left.wordLen());
 }
 
 bool operator==(const BigInt& left, const BigInt& right)
 {
-    return BigInt(left ^ right).isZero();
+    return compare(left, right) == 0;
 }
 
-bool operator!=(const BigInt &left, const BigInt &right)
+bool operator!=(const BigInt& left, const BigInt& right)
 {
-    return not (left == right);
+    return compare(left, right) != 0;
 }
 
 bool operator<(const BigInt& left, const BigInt& right)
 {
-    if (left.bitsLen() != right.bitsLen())
-        return left.bitsLen() < right.bitsLen();
-
-    for (size_t i = left.bitsLen(); i > 0; --i) {
-        bool leftBit = left.getBitAt(i - 1);
-        bool rightBit = right.getBitAt(i - 1);
-        if (leftBit != rightBit)
-            return leftBit < rightBit;
-    }
-    return false;
+    return compare(left, right) < 0;
 }
 
-bool operator<=(const BigInt& left, const BigInt &right)
+bool operator<=(const BigInt& left, const BigInt& right)
 {
-    return (left == right) or (left < right);
+    return compare(left, right) <= 0;
 }
 
 bool operator>(const BigInt& left, const BigInt& right)
 {
-    return not (left < right) and not (left == right);
+    return compare(left, right) > 0;
 }
 
-bool operator>=(const BigInt& left, const BigInt &right)
+bool operator>=(const BigInt& left, const BigInt& right)
 {
-    return (left == right) or (left > right);
+    return compare(left, right) >= 0;
 }
 
 BigInt operator&(const BigInt& left, const BigInt& right)
 {
-    std::vector<word> resultHeap(std::min(left.wordLen(), right.wordLen()), 0);
+    LimbVector resultHeap(std::min(left.wordLen(), right.wordLen()), 0);
     for (size_t i = 0; i < std::min(left.wordLen(), right.wordLen()); ++i)
         resultHeap[i] = left.getHeap()[i] & right.readHeap()[i];
 
@@ -181,7 +179,7 @@ BigInt operator&(const BigInt& left, const BigInt& right)
 
 BigInt operator|(const BigInt& left, const BigInt& right)
 {
-    std::vector<word> resultHeap(std::max(left.wordLen(), right.wordLen()), 0);
+    LimbVector resultHeap(std::max(left.wordLen(), right.wordLen()), 0);
     size_t minLen = std::min(left.wordLen(), right.wordLen());
     for (size_t i = 0; i < minLen; ++i)
         resultHeap[i] = left.getHeap()[i] | right.readHeap()[i];
@@ -197,7 +195,7 @@ BigInt operator|(const BigInt& left, const BigInt& right)
 
 BigInt operator^(const BigInt& left, const BigInt& right)
 {
-    std::vector<word> resultHeap(std::max(left.wordLen(), right.wordLen()), 0);
+    LimbVector resultHeap(std::max(left.wordLen(), right.wordLen()), 0);
     size_t minLen = std::min(left.wordLen(), right.wordLen());
     for (size_t i = 0; i < minLen; ++i)
         resultHeap[i] = left.getHeap()[i] ^ right.readHeap()[i];
@@ -213,45 +211,54 @@ BigInt operator^(const BigInt& left, const BigInt& right)
 
 BigInt operator>>(const BigInt& op, const size_t numOfShifts)
 {
-    std::vector<word> resultHeap(op.getHeap().begin(), op.getHeap().end());
-    for (size_t shiftIteration = 0; shiftIteration < numOfShifts; ++shiftIteration) {
-        resultHeap.front() >>= 1;
-        for (size_t i = 1; i < op.getHeap().size(); ++i) {
-            word carryMask = (word(1) & resultHeap[i]) << (bitsInWord - 1);
-            resultHeap[i] >>= 1;
-            resultHeap[i - 1] |= carryMask;
-        }
-    }
+    size_t wordShift = numOfShifts / bitsInWord;
+    if (wordShift >= op.wordLen())
+        return 0;
+
+    LimbVector resultHeap(op.wordLen() - wordShift);
+    shiftRightWords(resultHeap.data(), op.getHeap().data(), op.wordLen(), numOfShifts);
     return BigInt(std::move(resultHeap));
 }
 
 BigInt operator<<(const BigInt& op, const size_t numOfShifts)
 {
-    std::vector<word> resultHeap(op.getHeap().begin(), op.getHeap().end());
-    for (size_t shiftIteration = 0; shiftIteration < numOfShifts; ++shiftIteration) {
-        word carryMask = 0;
-        for (size_t i = 0; i < resultHeap.size(); ++i) {
-            word newMask = ((~(~word(0) >> 1)) & resultHeap[i]) >> (bitsInWord - 1);
-            resultHeap[i] <<= 1;
-            resultHeap[i] |= carryMask;
-            carryMask = newMask;
-        }
-        if (carryMask)
-            resultHeap.emplace_back(1);
-    }
+    if (op.isZero())
+        return 0;
+
+    LimbVector resultHeap(op.wordLen() + numOfShifts / bitsInWord + 1);
+    shiftLeftWords(resultHeap.data(), op.getHeap().data(), op.wordLen(), numOfShifts);
     return BigInt(std::move(resultHeap));
 }
 
 BigInt operator~(const BigInt &op)
 {
-    std::vector<word> resultHeap(op.wordLen());
+    LimbVector resultHeap(op.wordLen());
     for (size_t i = 0; i < op.wordLen(); ++i)
         resultHeap[i] = ~op.getHeap()[i];
 
-    BigInt result(std::move(resultHeap));
-    for (long i = op.wordLen() * bitsInWord; i > static_cast<long>(op.bitsLen()); --i)
-        result.setBitAt(i - 1, false);
+    // Only the bits below the highest set one are inverted
+    size_t topBits = op.bitsLen() - (op.wordLen() - 1) * bitsInWord;
+    if (topBits < bitsInWord)
+        resultHeap.back() &= ~(~word(0) << topBits);
 
+    return BigInt(std::move(resultHeap));
+}
+
+BigInt fromUint64(uint64_t op)
+{
+    if constexpr (bitsInWord == 64)
+        return static_cast<word>(op);
+    else
+        return BigInt(std::vector<word>{static_cast<word>(op), static_cast<word>(op >> bitsInWord)});
+}
+
+uint64_t toUint64(const BigInt& op)
+{
+    uint64_t result = 0;
+    for (size_t i = std::min<size_t>(op.wordLen(), 64 / bitsInWord); i > 0; --i) {
+        // Two half shifts stay defined for 64-bit words
+        result = (result << (bitsInWord / 2) << (bitsInWord / 2)) | op.getHeap()[i - 1];
+    }
     return result;
 }
 
@@ -269,16 +276,16 @@ BigInt gcd(const BigInt& left, const BigInt& right)
 
     while (((resultingLeft | resultingRight) & 1).isZero()) {
         ++shift;
-        resultingLeft = resultingLeft >> 1;
-        resultingRight = resultingRight >> 1;
+        resultingLeft >>= 1;
+        resultingRight >>= 1;
     }
 
     while ((resultingLeft & 1).isZero())
-        resultingLeft = resultingLeft >> 1;
+        resultingLeft >>= 1;
 
     do {
         while ((resultingRight & 1).isZero())
-            resultingRight = resultingRight >> 1;
+            resultingRight >>= 1;
 
         if (resultingLeft > resultingRight) {
             BigInt tmp = resultingRight;
@@ -292,3 +299,18 @@ BigInt gcd(const BigInt& left, const BigInt& right)
     return resultingLeft << shift;
 }
 
+
+BigInt modPow(const BigInt& base, const BigInt& exponent, const BigInt& modulo)
+{
+    return ModContext(modulo).powMod(base, exponent);
+}
+
+BigInt multiExp(const std::vector<BigInt>& bases, const std::vector<BigInt>& exponents, const BigInt& modulo)
+{
+    return ModContext(modulo).multiExp(bases, exponents);
+}
+
+BigInt modPowConstTime(const BigInt& base, const BigInt& exponent, const BigInt& modulo)
+{
+    return ModContext(modulo).powModConstTime(base, exponent);
+}
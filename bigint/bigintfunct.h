@@ -3,14 +3,23 @@
 
 #include "bigint.h"
 
+#include <cstdint>
+
 // Arithmetic
 BigInt operator+(const BigInt& left, const BigInt& right);
 BigInt operator-(const BigInt& left, const BigInt& right);
 BigInt operator*(const BigInt& left, const BigInt& right);
+// op * op, cheaper than the general product
+BigInt square(const BigInt& op);
+// Destination-passing forms, result reuses its own capacity and may be one of the operands
+void mul(BigInt& result, const BigInt& left, const BigInt& right);
+void sqr(BigInt& result, const BigInt& op);
 BigInt operator%(const BigInt& op, const BigInt& modulo);
 std::pair<BigInt, BigInt> divisionRemainder(const BigInt& numerator, const BigInt& denominator);
 
 // Comparisons
+// Three-way comparison: -1, 0 or 1. Decided by the word count or the first differing word.
+int compare(const BigInt& left, const BigInt& right);
 bool operator==(const BigInt& left, const BigInt& right);
 bool operator!=(const BigInt& left, const BigInt& right);
 bool operator<(const BigInt& left, const BigInt& right);
@@ -26,7 +35,20 @@ BigInt operator>>(const BigInt& op, const size_t numOfShifts);
 BigInt operator<<(const BigInt& op, const size_t numOfShifts);
 BigInt operator~(const BigInt& op);
 
+// Conversions of 64-bit integers whatever the limb width, toUint64 keeps the low 64 bits
+BigInt fromUint64(uint64_t op);
+uint64_t toUint64(const BigInt& op);
+
 // Algorithms
 BigInt gcd(const BigInt& left, const BigInt& right);
+// base^exponent mod modulo without ever building the full power. Odd moduli are
+// handled in Montgomery representation, even ones are reduced after every product.
+// Use ModContext::powMod directly to reuse the precomputation for the same modulo.
+BigInt modPow(const BigInt& base, const BigInt& exponent, const BigInt& modulo);
+// prod bases[i]^exponents[i] mod modulo, see ModContext::multiExp
+BigInt multiExp(const std::vector<BigInt>& bases, const std::vector<BigInt>& exponents, const BigInt& modulo);
+// Same as modPow for secret exponents: no branches or table lookups depend on exponent bits.
+// Odd moduli only. The member exponentiation methods of BigInt are not constant-time.
+BigInt modPowConstTime(const BigInt& base, const BigInt& exponent, const BigInt& modulo);
 
 #endif // BIGINTFUNCT_H
@@ -0,0 +1,290 @@
+#include "bigintkernel.h"
+
+#include <algorithm>
+#include <vector>
+
+size_t normalizedLen(const word* op, size_t len)
+{
+    while (len > 0 and op[len - 1] == 0)
+        --len;
+    return len;
+}
+
+word addWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen)
+{
+    word carry = 0;
+    size_t i = 0;
+    for (; i < rightLen; ++i)
+        result[i] = addCarry(left[i], right[i], carry);
+
+    // Only carry propagates through the rest of the longer operand
+    for (; i < leftLen; ++i)
+        result[i] = addCarry(left[i], 0, carry);
+
+    return carry;
+}
+
+word subWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen)
+{
+    word borrow = 0;
+    size_t i = 0;
+    for (; i < rightLen; ++i)
+        result[i] = subBorrow(left[i], right[i], borrow);
+
+    for (; i < leftLen; ++i)
+        result[i] = subBorrow(left[i], 0, borrow);
+
+    return borrow;
+}
+
+int compareWords(const word* left, const word* right, size_t len)
+{
+    for (size_t i = len; i > 0; --i) {
+        if (left[i - 1] != right[i - 1])
+            return left[i - 1] < right[i - 1] ? -1 : 1;
+    }
+    return 0;
+}
+
+word mulAddWord(word* result, const word* op, size_t len, word multiplier)
+{
+    word carry = 0;
+    for (size_t i = 0; i < len; ++i) {
+        word high;
+        word low = mulWide(op[i], multiplier, high);
+        word addCarryOut = 0;
+        low = addCarry(low, carry, addCarryOut);
+        high += addCarryOut;
+        addCarryOut = 0;
+        result[i] = addCarry(result[i], low, addCarryOut);
+        carry = high + addCarryOut;
+    }
+    return carry;
+}
+
+word subMulWord(word* result, const word* op, size_t len, word multiplier)
+{
+    word borrow = 0;
+    for (size_t i = 0; i < len; ++i) {
+        word high;
+        word low = mulWide(op[i], multiplier, high);
+        word carry = 0;
+        low = addCarry(low, borrow, carry);
+        high += carry;
+        carry = 0;
+        result[i] = subBorrow(result[i], low, carry);
+        borrow = high + carry;
+    }
+    return borrow;
+}
+
+word shiftLeftBits(word* result, const word* op, size_t len, unsigned shift)
+{
+    if (shift == 0) {
+        std::copy(op, op + len, result);
+        return 0;
+    }
+
+    word carry = 0;
+    for (size_t i = 0; i < len; ++i) {
+        word next = op[i] >> (bitsInWord - shift);
+        result[i] = (op[i] << shift) | carry;
+        carry = next;
+    }
+    return carry;
+}
+
+word shiftRightBits(word* result, const word* op, size_t len, unsigned shift)
+{
+    if (shift == 0) {
+        std::copy(op, op + len, result);
+        return 0;
+    }
+
+    word carry = 0;
+    for (size_t i = len; i > 0; --i) {
+        word next = op[i - 1] << (bitsInWord - shift);
+        result[i - 1] = (op[i - 1] >> shift) | carry;
+        carry = next;
+    }
+    return carry;
+}
+
+void shiftLeftWords(word* result, const word* op, size_t len, size_t shift)
+{
+    size_t wordShift = shift / bitsInWord;
+    unsigned bitShift = shift % bitsInWord;
+
+    // From the top down, so that the words are read before they are overwritten
+    result[len + wordShift] = bitShift == 0 ? 0 : op[len - 1] >> (bitsInWord - bitShift);
+    for (size_t i = len; i > 0; --i) {
+        word shifted = op[i - 1] << bitShift;
+        if (bitShift != 0 and i > 1)
+            shifted |= op[i - 2] >> (bitsInWord - bitShift);
+        result[i - 1 + wordShift] = shifted;
+    }
+    std::fill(result, result + wordShift, word(0));
+}
+
+void shiftRightWords(word* result, const word* op, size_t len, size_t shift)
+{
+    size_t wordShift = shift / bitsInWord;
+    unsigned bitShift = shift % bitsInWord;
+
+    size_t resultLen = len - wordShift;
+    for (size_t i = 0; i < resultLen; ++i) {
+        word shifted = op[i + wordShift] >> bitShift;
+        if (bitShift != 0 and i + 1 < resultLen)
+            shifted |= op[i + wordShift + 1] << (bitsInWord - bitShift);
+        result[i] = shifted;
+    }
+}
+
+word divModWord(word* quotient, const word* numerator, size_t len, word divisor)
+{
+    unsigned shift = countLeadingZeros(divisor);
+    word normalized = divisor << shift;
+    word reciprocal = reciprocalWord(normalized);
+
+    // The numerator is shifted on the fly along with the divisor
+    word remainder = shift == 0 ? 0 : numerator[len - 1] >> (bitsInWord - shift);
+    for (size_t i = len; i > 0; --i) {
+        word low = numerator[i - 1] << shift;
+        if (shift != 0 and i > 1)
+            low |= numerator[i - 2] >> (bitsInWord - shift);
+        quotient[i - 1] = divideWide(remainder, low, normalized, reciprocal, remainder);
+    }
+    return remainder >> shift;
+}
+
+void divModWords(word* quotient, word* remainder, const word* numerator, size_t numLen,
+                 const word* denominator, size_t denLen)
+{
+    if (denLen == 1) {
+        word lastRemainder = divModWord(quotient, numerator, numLen, denominator[0]);
+        if (remainder)
+            remainder[0] = lastRemainder;
+        return;
+    }
+
+    // Normalize so that the top bit of the divisor is set, then every quotient
+    // word estimate is at most 2 more than the real one
+    unsigned shift = countLeadingZeros(denominator[denLen - 1]);
+    std::vector<word> divisor(denLen);
+    std::vector<word> dividend(numLen + 1);
+    shiftLeftBits(divisor.data(), denominator, denLen, shift);
+    dividend[numLen] = shiftLeftBits(dividend.data(), numerator, numLen, shift);
+
+    const word divisorTop = divisor[denLen - 1];
+    const word divisorNext = divisor[denLen - 2];
+    const word reciprocal = reciprocalWord(divisorTop);
+
+    for (size_t j = numLen - denLen + 1; j > 0; --j) {
+        word* window = dividend.data() + j - 1;
+        word estimate;
+        word estimateRemainder;
+        word remainderOverflow = 0;
+        if (window[denLen] >= divisorTop) {
+            // Only equality is possible here, the estimate is clamped to the biggest word
+            estimate = maxWord;
+            estimateRemainder = addCarry(window[denLen - 1], divisorTop, remainderOverflow);
+        } else {
+            estimate = divideWide(window[denLen], window[denLen - 1], divisorTop, reciprocal, estimateRemainder);
+        }
+
+        // Use the second divisor word to make the estimate at most 1 too big
+        while (remainderOverflow == 0) {
+            word high;
+            word low = mulWide(estimate, divisorNext, high);
+            if (high < estimateRemainder or (high == estimateRemainder and low <= window[denLen - 2]))
+                break;
+            --estimate;
+            estimateRemainder = addCarry(estimateRemainder, divisorTop, remainderOverflow);
+        }
+
+        word borrow = subMulWord(window, divisor.data(), denLen, estimate);
+        word topBorrow = 0;
+        window[denLen] = subBorrow(window[denLen], borrow, topBorrow);
+        if (topBorrow) {
+            // Rare case of the estimate still being 1 too big
+            --estimate;
+            window[denLen] += addWords(window, window, denLen, divisor.data(), denLen);
+        }
+        quotient[j - 1] = estimate;
+    }
+
+    if (remainder)
+        shiftRightBits(remainder, dividend.data(), denLen, shift);
+}
+
+// result = value - modulo if value (with its top word) is at least modulo, value otherwise.
+// Selected with a mask rather than a branch, so it takes the same time either way.
+static void subtractModuloMasked(word* result, const word* value, word top, const word* modulo, size_t len)
+{
+    word borrow = subWords(result, value, len, modulo, len);
+    word keepDifference = word(0) - (top | (borrow ^ 1));
+    for (size_t i = 0; i < len; ++i)
+        result[i] = (result[i] & keepDifference) | (value[i] & ~keepDifference);
+}
+
+void montgomeryMulWords(word* result, const word* left, const word* right,
+                        const word* modulo, size_t len, word modInverse, word* scratch)
+{
+    word* t = scratch;
+    std::fill(t, t + len + 2, word(0));
+
+    for (size_t i = 0; i < len; ++i) {
+        // t += left * right[i]
+        word carry = mulAddWord(t, left, len, right[i]);
+        word topCarry = 0;
+        t[len] = addCarry(t[len], carry, topCarry);
+        t[len + 1] = topCarry;
+
+        // t = (t + m * modulo) / 2^bitsInWord, where m makes the lowest word vanish
+        word m = t[0] * modInverse;
+        carry = mulAddWord(t, modulo, len, m);
+        topCarry = 0;
+        t[len] = addCarry(t[len], carry, topCarry);
+        t[len + 1] += topCarry;
+        std::copy(t + 1, t + len + 2, t);
+        t[len + 1] = 0;
+    }
+
+    // t < 2 * modulo here, so a single subtraction is enough
+    subtractModuloMasked(result, t, t[len], modulo, len);
+}
+
+void montgomeryReduceWords(word* result, word* value, const word* modulo, size_t len, word modInverse)
+{
+    // Clear the low words one by one, adding multiples of modulo (SOS reduction)
+    for (size_t i = 0; i < len; ++i) {
+        word m = value[i] * modInverse;
+        word topCarry = 0;
+        value[i + len] = addCarry(value[i + len], mulAddWord(value + i, modulo, len, m), topCarry);
+        for (size_t j = i + len + 1; topCarry != 0 and j < 2 * len + 1; ++j)
+            value[j] = addCarry(value[j], 0, topCarry);
+    }
+
+    word* reduced = value + len;
+    subtractModuloMasked(result, reduced, reduced[len], modulo, len);
+}
+
+void scatterWords(word* table, size_t tableSize, size_t index, const word* op, size_t len)
+{
+    for (size_t i = 0; i < len; ++i)
+        table[i * tableSize + index] = op[i];
+}
+
+void gatherWords(word* result, const word* table, size_t tableSize, size_t index, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        word gathered = 0;
+        for (size_t entry = 0; entry < tableSize; ++entry) {
+            // All ones for the wanted entry, zero otherwise
+            word difference = word(entry ^ index);
+            word mask = ((difference | (word(0) - difference)) >> (bitsInWord - 1)) - 1;
+            gathered |= table[i * tableSize + entry] & mask;
+        }
+        result[i] = gathered;
+    }
+}
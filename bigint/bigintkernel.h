@@ -0,0 +1,172 @@
+#ifndef BIGINTKERNEL_H
+#define BIGINTKERNEL_H
+
+#include "bigint.h"
+#include "bigintconfig.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define BIGINT_HAS_ADDCARRY_INTRINSICS
+#endif
+
+// Limb-level kernels. Every array is little-endian (least significant word first)
+// and the caller is responsible for the output buffers being big enough.
+
+// Single word add/subtract with carry (borrow) in and out. Carry is always 0 or 1.
+inline word addCarry(word left, word right, word& carry)
+{
+#ifdef BIGINT_HAS_ADDCARRY_INTRINSICS
+#if BIGINT_WORD_BITS == 64
+    unsigned long long sum;
+    carry = _addcarry_u64(static_cast<unsigned char>(carry), left, right, &sum);
+#else
+    unsigned int sum;
+    carry = _addcarry_u32(static_cast<unsigned char>(carry), left, right, &sum);
+#endif
+    return sum;
+#else
+    dword sum = dword(left) + right + carry;
+    carry = static_cast<word>(sum >> bitsInWord);
+    return static_cast<word>(sum);
+#endif
+}
+
+inline word subBorrow(word left, word right, word& borrow)
+{
+#ifdef BIGINT_HAS_ADDCARRY_INTRINSICS
+#if BIGINT_WORD_BITS == 64
+    unsigned long long diff;
+    borrow = _subborrow_u64(static_cast<unsigned char>(borrow), left, right, &diff);
+#else
+    unsigned int diff;
+    borrow = _subborrow_u32(static_cast<unsigned char>(borrow), left, right, &diff);
+#endif
+    return diff;
+#else
+    dword diff = dword(left) - right - borrow;
+    borrow = static_cast<word>(diff >> bitsInWord) & word(1);
+    return static_cast<word>(diff);
+#endif
+}
+
+// Full double-width product of two words, the high word is returned through high.
+inline word mulWide(word left, word right, word& high)
+{
+    dword product = dword(left) * right;
+    high = static_cast<word>(product >> bitsInWord);
+    return static_cast<word>(product);
+}
+
+// Number of leading zero bits of a non-zero word.
+inline unsigned countLeadingZeros(word op)
+{
+#if defined(__GNUC__)
+#if BIGINT_WORD_BITS == 64
+    return static_cast<unsigned>(__builtin_clzll(op));
+#else
+    return static_cast<unsigned>(__builtin_clz(op));
+#endif
+#else
+    unsigned result = 0;
+    for (word mask = word(1) << (bitsInWord - 1); (op & mask) == 0; mask >>= 1)
+        ++result;
+    return result;
+#endif
+}
+
+// floor((2^(2 * bitsInWord) - 1) / divisor) - 2^bitsInWord for a divisor with its top bit set.
+inline word reciprocalWord(word divisor)
+{
+    return static_cast<word>(~dword(0) / divisor - (dword(1) << bitsInWord));
+}
+
+// Divides high:low by a normalized divisor using its precomputed reciprocal
+// (Moller-Granlund), requires high < divisor. Returns the quotient word.
+inline word divideWide(word high, word low, word divisor, word reciprocal, word& remainder)
+{
+    dword product = dword(reciprocal) * high + ((dword(high) << bitsInWord) | low);
+    word quotient = static_cast<word>(product >> bitsInWord) + 1;
+    word productLow = static_cast<word>(product);
+    remainder = low - quotient * divisor;
+    if (remainder > productLow) {
+        --quotient;
+        remainder += divisor;
+    }
+    if (remainder >= divisor) {
+        ++quotient;
+        remainder -= divisor;
+    }
+    return quotient;
+}
+
+// Length of the array without leading zero words.
+size_t normalizedLen(const word* op, size_t len);
+
+// result = left + right, requires leftLen >= rightLen. Writes leftLen words, returns carry.
+word addWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen);
+// result = left - right, requires leftLen >= rightLen. Writes leftLen words, returns borrow.
+word subWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen);
+// Three-way comparison of two arrays of the same length: -1, 0 or 1.
+int compareWords(const word* left, const word* right, size_t len);
+
+// result += op * multiplier over len words, returns the carry word.
+word mulAddWord(word* result, const word* op, size_t len, word multiplier);
+// result -= op * multiplier over len words, returns the borrow word.
+word subMulWord(word* result, const word* op, size_t len, word multiplier);
+
+// Shifts by less than a word. Both write len words, return the bits shifted out
+// (at the low end of the word for the left shift, at the high end for the right one).
+word shiftLeftBits(word* result, const word* op, size_t len, unsigned shift);
+word shiftRightBits(word* result, const word* op, size_t len, unsigned shift);
+// Shifts by any distance as a word move plus a single sub-word shift, result may be op itself.
+// The left shift writes len + shift / bitsInWord + 1 words, the right one
+// len - shift / bitsInWord words and needs shift / bitsInWord < len.
+void shiftLeftWords(word* result, const word* op, size_t len, size_t shift);
+void shiftRightWords(word* result, const word* op, size_t len, size_t shift);
+
+// Divides by a single word, writes len quotient words and returns the remainder.
+word divModWord(word* quotient, const word* numerator, size_t len, word divisor);
+// Knuth's algorithm D. Both lengths must be normalized with numLen >= denLen. Writes
+// numLen - denLen + 1 quotient words and denLen remainder words (remainder may be null).
+void divModWords(word* quotient, word* remainder, const word* numerator, size_t numLen,
+                 const word* denominator, size_t denLen);
+
+// Crossover sizes of the multiplication algorithms, initialized from bigintconfig.h.
+// Changeable at run time for tuning.
+struct MulThresholds
+{
+    size_t karatsuba;
+    size_t toom3;
+};
+MulThresholds& mulThresholds();
+
+// result = left * right, requires leftLen >= rightLen > 0. Writes leftLen + rightLen words,
+// result must not overlap the operands. Dispatches between the algorithms below.
+void mulWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen);
+void mulSchoolbookWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen);
+// Both require leftLen >= rightLen and fall back to simpler algorithms for unsuitable shapes
+void mulKaratsubaWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen);
+void mulToom3Words(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen);
+
+// result = op^2 over 2 * len words, result must not overlap op. Every cross product is
+// computed once and doubled, so squaring is cheaper than the general multiplication.
+void sqrWords(word* result, const word* op, size_t len);
+void sqrSchoolbookWords(word* result, const word* op, size_t len);
+void sqrKaratsubaWords(word* result, const word* op, size_t len);
+
+// Montgomery product result = left * right * R^-1 mod modulo (R = 2^(len * bitsInWord)),
+// CIOS variant. Operands must be less than modulo, modInverse = -modulo^-1 mod 2^bitsInWord.
+// Needs len + 2 scratch words, result may alias the operands. Runs in time depending on len only.
+void montgomeryMulWords(word* result, const word* left, const word* right,
+                        const word* modulo, size_t len, word modInverse, word* scratch);
+// Montgomery reduction result = value * R^-1 mod modulo of a value less than modulo * R.
+// value holds 2 * len + 1 words (the top one zero) and is destroyed.
+void montgomeryReduceWords(word* result, word* value, const word* modulo, size_t len, word modInverse);
+
+// Table of len-word entries stored interleaved: word i of entry e lives at i * tableSize + e.
+// gatherWords reads every entry and keeps the wanted one with a mask, so neither
+// the memory access pattern nor the timing depend on a secret index.
+void scatterWords(word* table, size_t tableSize, size_t index, const word* op, size_t len);
+void gatherWords(word* result, const word* table, size_t tableSize, size_t index, size_t len);
+
+#endif // BIGINTKERNEL_H
@@ -0,0 +1,329 @@
+#include "bigintkernel.h"
+
+#include <algorithm>
+#include <vector>
+
+// Below these sizes the recursive algorithms would not make their operands any shorter
+constexpr size_t minKaratsubaLen = 4;
+constexpr size_t minToom3Len = 12;
+
+MulThresholds& mulThresholds()
+{
+    static MulThresholds thresholds{BIGINT_KARATSUBA_THRESHOLD, BIGINT_TOOM3_THRESHOLD};
+    return thresholds;
+}
+
+// Temporaries of the recursive algorithms come from a per-thread buffer for every
+// recursion depth. They grow to the biggest size seen and are reused afterwards,
+// so repeated products of similar sizes do not allocate.
+static thread_local std::vector<std::vector<word>> scratchBuffers;
+static thread_local size_t scratchDepth = 0;
+
+class ScratchFrame
+{
+public:
+    explicit ScratchFrame(size_t size)
+    {
+        if (scratchBuffers.size() <= scratchDepth)
+            scratchBuffers.resize(scratchDepth + 1);
+        // Moving the outer vector keeps the buffers of the outer frames in place
+        std::vector<word>& buffer = scratchBuffers[scratchDepth++];
+        if (buffer.size() < size)
+            buffer.resize(size);
+        _data = buffer.data();
+        std::fill(_data, _data + size, word(0));
+    }
+
+    ~ScratchFrame()
+    {
+        --scratchDepth;
+    }
+
+    ScratchFrame(const ScratchFrame&) = delete;
+    ScratchFrame& operator=(const ScratchFrame&) = delete;
+
+    word* data()
+    {
+        return _data;
+    }
+
+private:
+    word* _data;
+};
+
+// target += op, the carry runs through the rest of target
+static void addInto(word* target, size_t targetLen, const word* op, size_t opLen)
+{
+    word carry = addWords(target, target, opLen, op, opLen);
+    for (size_t i = opLen; carry != 0 and i < targetLen; ++i)
+        target[i] = addCarry(target[i], 0, carry);
+}
+
+// Operands of very different lengths: multiply the longer one chunk by chunk
+static void mulChunkedWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen)
+{
+    std::fill(result, result + leftLen + rightLen, word(0));
+    ScratchFrame frame(2 * rightLen);
+    word* chunkProduct = frame.data();
+    for (size_t offset = 0; offset < leftLen; offset += rightLen) {
+        size_t chunkLen = std::min(rightLen, leftLen - offset);
+        if (chunkLen == rightLen)
+            mulWords(chunkProduct, left + offset, chunkLen, right, rightLen);
+        else
+            mulWords(chunkProduct, right, rightLen, left + offset, chunkLen);
+        addInto(result + offset, leftLen + rightLen - offset, chunkProduct, chunkLen + rightLen);
+    }
+}
+
+void mulWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen)
+{
+    const MulThresholds& thresholds = mulThresholds();
+    if (rightLen < std::max(thresholds.karatsuba, minKaratsubaLen))
+        mulSchoolbookWords(result, left, leftLen, right, rightLen);
+    else if (leftLen >= 2 * rightLen)
+        mulChunkedWords(result, left, leftLen, right, rightLen);
+    else if (rightLen < std::max(thresholds.toom3, minToom3Len))
+        mulKaratsubaWords(result, left, leftLen, right, rightLen);
+    else
+        mulToom3Words(result, left, leftLen, right, rightLen);
+}
+
+void mulSchoolbookWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen)
+{
+    std::fill(result, result + leftLen, word(0));
+    for (size_t i = 0; i < rightLen; ++i)
+        result[leftLen + i] = mulAddWord(result + i, left, leftLen, right[i]);
+}
+
+void mulKaratsubaWords(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen)
+{
+    // left = left1 * B^half + left0, right = right1 * B^half + right0
+    size_t half = (leftLen + 1) / 2;
+    if (rightLen <= half) {
+        mulChunkedWords(result, left, leftLen, right, rightLen);
+        return;
+    }
+    size_t leftHighLen = leftLen - half;
+    size_t rightHighLen = rightLen - half;
+
+    // Low and high products go straight to their places in the result
+    mulWords(result, left, half, right, half);
+    mulWords(result + 2 * half, left + half, leftHighLen, right + half, rightHighLen);
+
+    // Cross product (left0 + left1) * (right0 + right1) - low - high
+    size_t crossLen = 2 * half + 2;
+    ScratchFrame frame(2 * (half + 1) + crossLen);
+    word* leftSum = frame.data();
+    word* rightSum = leftSum + half + 1;
+    word* cross = rightSum + half + 1;
+    leftSum[half] = addWords(leftSum, left, half, left + half, leftHighLen);
+    rightSum[half] = addWords(rightSum, right, half, right + half, rightHighLen);
+
+    mulWords(cross, leftSum, half + 1, rightSum, half + 1);
+    subWords(cross, cross, crossLen, result, 2 * half);
+    subWords(cross, cross, crossLen, result + 2 * half, leftHighLen + rightHighLen);
+
+    size_t resultLen = leftLen + rightLen;
+    addInto(result + half, resultLen - half, cross, normalizedLen(cross, crossLen));
+}
+
+void sqrWords(word* result, const word* op, size_t len)
+{
+    const MulThresholds& thresholds = mulThresholds();
+    if (len < std::max(thresholds.karatsuba, minKaratsubaLen))
+        sqrSchoolbookWords(result, op, len);
+    else if (len < std::max(thresholds.toom3, minToom3Len))
+        sqrKaratsubaWords(result, op, len);
+    else
+        mulToom3Words(result, op, len, op, len);
+}
+
+void sqrSchoolbookWords(word* result, const word* op, size_t len)
+{
+    // Cross products op[i] * op[j] with i < j, each of them once
+    std::fill(result, result + 2 * len, word(0));
+    for (size_t i = 0; i + 1 < len; ++i)
+        result[i + len] = mulAddWord(result + 2 * i + 1, op + i + 1, len - i - 1, op[i]);
+
+    // Double them and add the squares on the diagonal
+    shiftLeftBits(result, result, 2 * len, 1);
+    word carry = 0;
+    for (size_t i = 0; i < len; ++i) {
+        word high;
+        word low = mulWide(op[i], op[i], high);
+        result[2 * i] = addCarry(result[2 * i], low, carry);
+        result[2 * i + 1] = addCarry(result[2 * i + 1], high, carry);
+    }
+}
+
+void sqrKaratsubaWords(word* result, const word* op, size_t len)
+{
+    // op = op1 * B^half + op0, op^2 = op1^2 * B^2half + ((op0 + op1)^2 - op0^2 - op1^2) * B^half + op0^2
+    size_t half = (len + 1) / 2;
+    size_t highLen = len - half;
+
+    sqrWords(result, op, half);
+    sqrWords(result + 2 * half, op + half, highLen);
+
+    size_t crossLen = 2 * half + 2;
+    ScratchFrame frame(half + 1 + crossLen);
+    word* sum = frame.data();
+    word* cross = sum + half + 1;
+    sum[half] = addWords(sum, op, half, op + half, highLen);
+
+    sqrWords(cross, sum, half + 1);
+    subWords(cross, cross, crossLen, result, 2 * half);
+    subWords(cross, cross, crossLen, result + 2 * half, 2 * highLen);
+
+    addInto(result + half, 2 * len - half, cross, normalizedLen(cross, crossLen));
+}
+
+// Intermediate values of Toom-Cook interpolation can be negative
+struct SignedWords
+{
+    std::vector<word> magnitude;
+    bool negative = false;
+};
+
+static SignedWords toSigned(const word* op, size_t len)
+{
+    return {std::vector<word>(op, op + normalizedLen(op, len)), false};
+}
+
+static int compareMagnitudes(const std::vector<word>& left, const std::vector<word>& right)
+{
+    if (left.size() != right.size())
+        return left.size() < right.size() ? -1 : 1;
+    return compareWords(left.data(), right.data(), left.size());
+}
+
+static SignedWords signedAdd(const SignedWords& left, const SignedWords& right)
+{
+    const SignedWords& longer = left.magnitude.size() >= right.magnitude.size() ? left : right;
+    const SignedWords& shorter = left.magnitude.size() >= right.magnitude.size() ? right : left;
+    SignedWords result;
+    if (left.negative == right.negative) {
+        result.magnitude.resize(longer.magnitude.size() + 1);
+        result.magnitude.back() = addWords(result.magnitude.data(),
+                                           longer.magnitude.data(), longer.magnitude.size(),
+                                           shorter.magnitude.data(), shorter.magnitude.size());
+        result.negative = left.negative;
+    } else {
+        bool leftBigger = compareMagnitudes(left.magnitude, right.magnitude) >= 0;
+        const SignedWords& bigger = leftBigger ? left : right;
+        const SignedWords& smaller = leftBigger ? right : left;
+        result.magnitude.resize(bigger.magnitude.size());
+        subWords(result.magnitude.data(), bigger.magnitude.data(), bigger.magnitude.size(),
+                 smaller.magnitude.data(), smaller.magnitude.size());
+        result.negative = bigger.negative;
+    }
+    result.magnitude.resize(normalizedLen(result.magnitude.data(), result.magnitude.size()));
+    if (result.magnitude.empty())
+        result.negative = false;
+    return result;
+}
+
+static SignedWords signedSub(const SignedWords& left, SignedWords right)
+{
+    if (not right.magnitude.empty())
+        right.negative = not right.negative;
+    return signedAdd(left, right);
+}
+
+static SignedWords signedMul(const SignedWords& left, const SignedWords& right)
+{
+    if (left.magnitude.empty() or right.magnitude.empty())
+        return {};
+
+    const std::vector<word>& longer = left.magnitude.size() >= right.magnitude.size() ? left.magnitude : right.magnitude;
+    const std::vector<word>& shorter = left.magnitude.size() >= right.magnitude.size() ? right.magnitude : left.magnitude;
+    SignedWords result;
+    result.magnitude.resize(longer.size() + shorter.size());
+    mulWords(result.magnitude.data(), longer.data(), longer.size(), shorter.data(), shorter.size());
+    result.magnitude.resize(normalizedLen(result.magnitude.data(), result.magnitude.size()));
+    result.negative = left.negative != right.negative;
+    return result;
+}
+
+static SignedWords signedSquare(const SignedWords& op)
+{
+    if (op.magnitude.empty())
+        return {};
+
+    SignedWords result;
+    result.magnitude.resize(2 * op.magnitude.size());
+    sqrWords(result.magnitude.data(), op.magnitude.data(), op.magnitude.size());
+    result.magnitude.resize(normalizedLen(result.magnitude.data(), result.magnitude.size()));
+    return result;
+}
+
+static SignedWords signedDouble(SignedWords op)
+{
+    word carry = shiftLeftBits(op.magnitude.data(), op.magnitude.data(), op.magnitude.size(), 1);
+    if (carry != 0)
+        op.magnitude.push_back(carry);
+    return op;
+}
+
+// Exact division, the remainder is known to be zero
+static SignedWords signedDivide(SignedWords op, word divisor)
+{
+    if (op.magnitude.empty())
+        return op;
+    divModWord(op.magnitude.data(), op.magnitude.data(), op.magnitude.size(), divisor);
+    op.magnitude.resize(normalizedLen(op.magnitude.data(), op.magnitude.size()));
+    return op;
+}
+
+void mulToom3Words(word* result, const word* left, size_t leftLen, const word* right, size_t rightLen)
+{
+    // Both operands are split into three parts of partLen words: x = x2 * B^2k + x1 * B^k + x0
+    size_t partLen = (leftLen + 2) / 3;
+    if (rightLen <= 2 * partLen) {
+        mulKaratsubaWords(result, left, leftLen, right, rightLen);
+        return;
+    }
+
+    // Evaluation in 0, 1, -1, -2 and infinity (Bodrato's sequence)
+    auto evaluate = [partLen](const word* op, size_t len) {
+        SignedWords part0 = toSigned(op, partLen);
+        SignedWords part1 = toSigned(op + partLen, partLen);
+        SignedWords part2 = toSigned(op + 2 * partLen, len - 2 * partLen);
+        SignedWords outer = signedAdd(part0, part2);
+        SignedWords atOne = signedAdd(outer, part1);
+        SignedWords atMinusOne = signedSub(outer, part1);
+        SignedWords atMinusTwo = signedSub(signedDouble(signedAdd(atMinusOne, part2)), part0);
+        return std::vector<SignedWords>{part0, atOne, atMinusOne, atMinusTwo, part2};
+    };
+    std::vector<SignedWords> leftPoints = evaluate(left, leftLen);
+    std::vector<SignedWords> rightPoints = evaluate(right, rightLen);
+
+    // Squaring evaluates the same points twice, the point products become squares
+    bool squaring = left == right and leftLen == rightLen;
+    auto pointProduct = [&](size_t point) {
+        return squaring ? signedSquare(leftPoints[point]) : signedMul(leftPoints[point], rightPoints[point]);
+    };
+    SignedWords r0 = pointProduct(0);
+    SignedWords r1 = pointProduct(1);
+    SignedWords rm1 = pointProduct(2);
+    SignedWords rm2 = pointProduct(3);
+    SignedWords rInf = pointProduct(4);
+
+    // Interpolation
+    SignedWords c3 = signedDivide(signedSub(rm2, r1), 3);
+    SignedWords c1 = signedDivide(signedSub(r1, rm1), 2);
+    SignedWords c2 = signedSub(rm1, r0);
+    c3 = signedAdd(signedDivide(signedSub(c2, c3), 2), signedDouble(rInf));
+    c2 = signedSub(signedAdd(c2, c1), rInf);
+    c1 = signedSub(c1, c3);
+
+    // All the coefficients are non-negative by now
+    size_t resultLen = leftLen + rightLen;
+    std::fill(result, result + resultLen, word(0));
+    const SignedWords* coefficients[] = {&r0, &c1, &c2, &c3, &rInf};
+    for (size_t i = 0; i < 5; ++i) {
+        const std::vector<word>& magnitude = coefficients[i]->magnitude;
+        if (not magnitude.empty())
+            addInto(result + i * partLen, resultLen - i * partLen, magnitude.data(), magnitude.size());
+    }
+}
@@ -0,0 +1,172 @@
+#ifndef EXPSCHEDULE_H
+#define EXPSCHEDULE_H
+
+#include "bigint.h"
+#include "bigintconfig.h"
+#include "bigintfunct.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+// Exponentiation schedules shared by plain and modular exponentiation.
+// The arithmetic is supplied by the caller in destination-passing form as
+// multiply(result, left, right) and square(result, op), where result may be an operand,
+// and "one" is the neutral element in the caller's representation
+// (e.g. R mod n for Montgomery arithmetic). The loops work on a single result in place,
+// so they allocate nothing once the arithmetic has warmed up.
+
+// count bits of exponent starting at bit from, count is less than bitsInWord
+inline word exponentWindow(const BigInt& exponent, size_t from, size_t count)
+{
+    const LimbVector& heap = exponent.getHeap();
+    size_t wordNum = from / bitsInWord;
+    size_t offset = from % bitsInWord;
+    if (wordNum >= heap.size())
+        return 0;
+
+    word window = heap[wordNum] >> offset;
+    if (offset + count > bitsInWord and wordNum + 1 < heap.size())
+        window |= heap[wordNum + 1] << (bitsInWord - offset);
+    return window & ~(~word(0) << count);
+}
+
+enum class ExpWindowMethod
+{
+    MAry,
+    SlidingWindow
+};
+
+// Cost of a squaring relative to a multiplication of operands of the given length,
+// measured by tune-exponentiation at 1, 4, 16, 64 and 256 words (see bigintconfig.h)
+inline double sqrCostRatio(size_t operandWords)
+{
+    constexpr unsigned percents[] = {BIGINT_SQR_COST_PERCENT};
+    size_t index = 0;
+    while (index + 1 < std::size(percents) and (size_t(4) << (2 * index)) <= operandWords)
+        ++index;
+    return percents[index] / 100.0;
+}
+
+// Window size for the given exponent length minimizing the cost, in multiplications,
+// of the odd powers table (one squaring and 2^(k-1) - 1 multiplications) plus the expected
+// window multiplications: bits / (k + 1) for sliding window, (1 - 2^-k) per k bits for m-ary.
+// The squarings of the main loop do not depend on k.
+inline word expWindowK(size_t exponentBits, size_t operandWords,
+                       ExpWindowMethod method = ExpWindowMethod::SlidingWindow)
+{
+    constexpr word maxK = 10;
+    double bits = static_cast<double>(exponentBits);
+    double sqrCost = sqrCostRatio(operandWords);
+    word bestK = 1;
+    double bestCost = 0;
+    for (word k = 1; k <= maxK; ++k) {
+        double cost = k == 1 ? 0 : sqrCost + static_cast<double>((size_t(1) << (k - 1)) - 1);
+        if (method == ExpWindowMethod::SlidingWindow)
+            cost += bits / (k + 1);
+        else
+            cost += bits / k * (1 - 1.0 / static_cast<double>(size_t(1) << k));
+
+        if (k == 1 or cost < bestCost) {
+            bestCost = cost;
+            bestK = k;
+        }
+    }
+    return bestK;
+}
+
+// Powers base^0 .. base^(2^k - 1)
+template <typename Multiply>
+std::vector<BigInt> expTableSchedule(const BigInt& base, const BigInt& one, word k, Multiply&& multiply)
+{
+    std::vector<BigInt> table(size_t(1) << k);
+    table[0] = one;
+    for (size_t i = 1; i < table.size(); ++i)
+        multiply(table[i], base, table[i - 1]);
+    return table;
+}
+
+// Odd powers base^1, base^3 .. base^(2^k - 1), half the table of expTableSchedule
+template <typename Multiply, typename Square>
+std::vector<BigInt> oddExpTableSchedule(const BigInt& base, word k, Multiply&& multiply, Square&& square)
+{
+    std::vector<BigInt> table(size_t(1) << (k - 1));
+    table[0] = base;
+    if (table.size() > 1) {
+        BigInt baseSquare;
+        square(baseSquare, base);
+        for (size_t i = 1; i < table.size(); ++i)
+            multiply(table[i], table[i - 1], baseSquare);
+    }
+    return table;
+}
+
+// m-ary method on an odd powers table: a window digit u * 2^t with odd u is applied
+// as a multiplication by base^u followed by t of the squarings of the next windows
+template <typename Multiply, typename Square>
+BigInt mAryLRSchedule(const std::vector<BigInt>& oddPowers, const BigInt& one, const BigInt& exponent,
+                      word k, Multiply&& multiply, Square&& square)
+{
+    size_t windowsCount = (exponent.bitsLen() + k - 1) / k;
+    BigInt result = one;
+    bool started = false;
+    size_t pendingSquares = 0;
+    for (size_t i = windowsCount; i > 0; --i) {
+        word digit = exponentWindow(exponent, (i - 1) * k, k);
+        if (digit == 0) {
+            pendingSquares += k;
+            continue;
+        }
+
+        word t = 0;
+        while ((digit & 1) == 0) {
+            digit >>= 1;
+            ++t;
+        }
+        pendingSquares += k - t;
+        if (started) {
+            for (; pendingSquares > 0; --pendingSquares)
+                square(result, result);
+            multiply(result, result, oddPowers.at(digit >> 1));
+        } else {
+            result = oddPowers.at(digit >> 1);
+            started = true;
+        }
+        pendingSquares = t;
+    }
+
+    if (started) {
+        for (; pendingSquares > 0; --pendingSquares)
+            square(result, result);
+    }
+    return result;
+}
+
+// Every window starts and ends with a set bit, so only odd powers are used
+template <typename Multiply, typename Square>
+BigInt slidingWindowSchedule(const std::vector<BigInt>& oddPowers, const BigInt& one, const BigInt& exponent,
+                             word k, Multiply&& multiply, Square&& square)
+{
+    BigInt result = one;
+    for (int64_t i = static_cast<int64_t>(exponent.bitsLen()) - 1; i >= 0;) {
+        if (exponent.getBitAt(i) == false) {
+           square(result, result);
+           --i;
+        } else {
+            int64_t s = std::max(i - static_cast<int64_t>(k) + 1, int64_t(0));
+            while (exponent.getBitAt(s) == false)
+                ++s;
+
+            for (int64_t h = 0; h < i - s + 1; ++h)
+                square(result, result);
+
+            word u = exponentWindow(exponent, s, i - s + 1);
+            multiply(result, result, oddPowers.at(u >> 1));
+            i = s - 1;
+        }
+    }
+    return result;
+}
+
+#endif // EXPSCHEDULE_H
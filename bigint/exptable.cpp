@@ -0,0 +1,90 @@
+#include "exptable.h"
+#include "bigintfunct.h"
+#include "expschedule.h"
+
+#include <stdexcept>
+
+static word checkedK(word k)
+{
+    if (k == 0 or k > maxExpTableK)
+        throw std::logic_error("Exponentiation window has to be from 1 to " + std::to_string(maxExpTableK) + " bits");
+    return k;
+}
+
+ExpTable::ExpTable(const BigInt& base, word k)
+    : _base(base), _k(checkedK(k)), _one(1)
+{
+    _powers = oddExpTableSchedule(_base, _k,
+                                  [](BigInt& result, const BigInt& left, const BigInt& right) { mul(result, left, right); },
+                                  [](BigInt& result, const BigInt& op) { sqr(result, op); });
+}
+
+ExpTable::ExpTable(const BigInt& base, word k, const BigInt& modulo)
+    : ExpTable(base, k, std::make_shared<const ModContext>(modulo))
+{
+}
+
+ExpTable::ExpTable(const BigInt& base, word k, const ModContext& context)
+    : ExpTable(base, k, context, nullptr)
+{
+}
+
+ExpTable::ExpTable(const BigInt& base, word k, std::shared_ptr<const ModContext> context)
+    : ExpTable(base, k, *context, context)
+{
+}
+
+ExpTable::ExpTable(const BigInt& base, word k, const ModContext& context,
+                   std::shared_ptr<const ModContext> ownedContext)
+    : _base(base), _k(checkedK(k)), _ownedContext(std::move(ownedContext)), _context(&context),
+      _one(context.workingOne())
+{
+    _powers = oddExpTableSchedule(_context->toWorking(_base), _k,
+                                  [this](BigInt& result, const BigInt& left, const BigInt& right) {
+                                      _context->mulWorking(result, left, right);
+                                  },
+                                  [this](BigInt& result, const BigInt& op) { _context->sqrWorking(result, op); });
+}
+
+template <typename Schedule>
+BigInt ExpTable::withArithmetic(Schedule&& schedule) const
+{
+    if (not _context)
+        return schedule([](BigInt& result, const BigInt& left, const BigInt& right) { mul(result, left, right); },
+                        [](BigInt& result, const BigInt& op) { sqr(result, op); });
+
+    BigInt result = schedule([this](BigInt& result, const BigInt& left, const BigInt& right) {
+                                 _context->mulWorking(result, left, right);
+                             },
+                             [this](BigInt& result, const BigInt& op) { _context->sqrWorking(result, op); });
+    return _context->fromWorking(result);
+}
+
+BigInt ExpTable::mAryLRExp(const BigInt& exponent) const
+{
+    return withArithmetic([&](auto&& multiply, auto&& square) {
+        return mAryLRSchedule(_powers, _one, exponent, _k, multiply, square);
+    });
+}
+
+BigInt ExpTable::slidingWindowExp(const BigInt& exponent) const
+{
+    return withArithmetic([&](auto&& multiply, auto&& square) {
+        return slidingWindowSchedule(_powers, _one, exponent, _k, multiply, square);
+    });
+}
+
+const BigInt& ExpTable::getBase() const
+{
+    return _base;
+}
+
+word ExpTable::getK() const
+{
+    return _k;
+}
+
+const ModContext* ExpTable::getModContext() const
+{
+    return _context;
+}
@@ -0,0 +1,52 @@
+#ifndef EXPTABLE_H
+#define EXPTABLE_H
+
+#include "bigint.h"
+#include "modcontext.h"
+
+#include <memory>
+#include <vector>
+
+// Widest window of a table, 2^15 powers
+constexpr word maxExpTableK = 16;
+
+// Odd powers base^1, base^3 .. base^(2^k - 1) for the window exponentiations, either plain or
+// modulo a number (kept in the working representation of its ModContext).
+// A table never changes once built, so it can be shared between threads
+// and reused for any number of exponents of the same base.
+// k has to be in [1, maxExpTableK], std::logic_error is thrown otherwise.
+class ExpTable
+{
+public:
+    ExpTable(const BigInt& base, word k);
+    // Builds its own ModContext and keeps it
+    ExpTable(const BigInt& base, word k, const BigInt& modulo);
+    // Refers to the context without copying it, the context has to outlive the table
+    ExpTable(const BigInt& base, word k, const ModContext& context);
+
+    BigInt mAryLRExp(const BigInt& exponent) const;
+    BigInt slidingWindowExp(const BigInt& exponent) const;
+
+    const BigInt& getBase() const;
+    word getK() const;
+    // Present for tables built modulo a number, nullptr otherwise
+    const ModContext* getModContext() const;
+
+private:
+    ExpTable(const BigInt& base, word k, std::shared_ptr<const ModContext> context);
+    ExpTable(const BigInt& base, word k, const ModContext& context, std::shared_ptr<const ModContext> ownedContext);
+
+    // Calls schedule(multiply, square) with the arithmetic matching the table
+    // and converts its result back to plain representation
+    template <typename Schedule>
+    BigInt withArithmetic(Schedule&& schedule) const;
+
+    BigInt _base;
+    word _k;
+    std::shared_ptr<const ModContext> _ownedContext;
+    const ModContext* _context = nullptr;
+    BigInt _one;
+    std::vector<BigInt> _powers;
+};
+
+#endif // EXPTABLE_H
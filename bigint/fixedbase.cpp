@@ -0,0 +1,172 @@
+#include "fixedbase.h"
+#include "bigintfunct.h"
+#include "expschedule.h"
+#include "exptable.h"
+
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+static const std::string fileHeader = "fixed-base-comb-v1";
+
+// Every table needs a column of its own and tables << teeth powers have to fit in memory
+static bool validParameters(size_t maxExponentBits, size_t teeth, size_t tables)
+{
+    if (maxExponentBits == 0 or teeth == 0 or teeth > maxExpTableK or tables == 0)
+        return false;
+    size_t rowBits = (maxExponentBits + teeth - 1) / teeth;
+    return tables <= rowBits and tables <= (std::numeric_limits<size_t>::max() >> teeth);
+}
+
+FixedBaseComb::FixedBaseComb(const BigInt& base, const ModContext& context, size_t maxExponentBits,
+                             size_t teeth, size_t tables)
+    : _base(base), _context(context), _maxExponentBits(maxExponentBits), _teeth(teeth), _tables(tables)
+{
+    checkParameters();
+
+    // base^(2^(i * a)) for every row i
+    std::vector<BigInt> rowPowers(_teeth);
+    rowPowers[0] = _context.toWorking(_base);
+    for (size_t i = 1; i < _teeth; ++i) {
+        rowPowers[i] = rowPowers[i - 1];
+        for (size_t j = 0; j < _rowBits; ++j)
+            _context.sqrWorking(rowPowers[i], rowPowers[i]);
+    }
+
+    // First table: products over the rows selected by the bits of u
+    size_t tableSize = size_t(1) << _teeth;
+    _powers.resize(_tables * tableSize);
+    _powers[0] = _context.workingOne();
+    for (size_t u = 1; u < tableSize; ++u) {
+        size_t row = 0;
+        while (((u >> row) & 1) == 0)
+            ++row;
+        _context.mulWorking(_powers[u], _powers[u ^ (size_t(1) << row)], rowPowers[row]);
+    }
+
+    // Every next table is the previous one raised to 2^b
+    for (size_t j = 1; j < _tables; ++j) {
+        for (size_t u = 0; u < tableSize; ++u) {
+            BigInt& power = _powers[j * tableSize + u];
+            power = _powers[(j - 1) * tableSize + u];
+            for (size_t i = 0; i < _blockBits; ++i)
+                _context.sqrWorking(power, power);
+        }
+    }
+}
+
+FixedBaseComb::FixedBaseComb(const BigInt& base, const ModContext& context, size_t maxExponentBits,
+                             size_t teeth, size_t tables, std::vector<BigInt>&& powers)
+    : _base(base), _context(context), _maxExponentBits(maxExponentBits), _teeth(teeth), _tables(tables),
+      _powers(std::move(powers))
+{
+    checkParameters();
+    if (_powers.size() != _tables << _teeth)
+        throw std::runtime_error("Fixed-base table has a wrong number of powers");
+}
+
+void FixedBaseComb::checkParameters()
+{
+    if (_maxExponentBits == 0 or _teeth == 0 or _tables == 0)
+        throw std::logic_error("Fixed-base comb parameters must be positive");
+    if (not validParameters(_maxExponentBits, _teeth, _tables))
+        throw std::logic_error("Fixed-base comb can have 16 teeth and a table per row bit at most");
+
+    _rowBits = (_maxExponentBits + _teeth - 1) / _teeth;
+    _blockBits = (_rowBits + _tables - 1) / _tables;
+}
+
+BigInt FixedBaseComb::pow(const BigInt& exponent) const
+{
+    if (exponent.bitsLen() > _maxExponentBits)
+        return _context.powMod(_base, exponent);
+
+    size_t tableSize = size_t(1) << _teeth;
+    BigInt result = _context.workingOne();
+    for (size_t column = _blockBits; column > 0; --column) {
+        if (column != _blockBits)
+            _context.sqrWorking(result, result);
+
+        for (size_t j = _tables; j > 0; --j) {
+            size_t bit = (j - 1) * _blockBits + column - 1;
+            if (bit >= _rowBits)
+                continue;
+
+            // One exponent bit from every row makes up the table index
+            size_t u = 0;
+            for (size_t row = 0; row < _teeth; ++row)
+                u |= static_cast<size_t>(exponentWindow(exponent, row * _rowBits + bit, 1)) << row;
+            if (u != 0)
+                _context.mulWorking(result, result, _powers[(j - 1) * tableSize + u]);
+        }
+    }
+    return _context.fromWorking(result);
+}
+
+void FixedBaseComb::save(std::ostream& stream) const
+{
+    stream << fileHeader << '\n'
+           << _context.getModulo().getStr(BigInt::Hex) << '\n'
+           << _base.getStr(BigInt::Hex) << '\n'
+           << _maxExponentBits << ' ' << _teeth << ' ' << _tables << '\n';
+
+    // Powers go out in plain representation, Montgomery form depends on the limb width
+    for (const BigInt& power : _powers)
+        stream << _context.fromWorking(power).getStr(BigInt::Hex) << '\n';
+}
+
+FixedBaseComb FixedBaseComb::load(std::istream& stream)
+{
+    std::string header;
+    std::string modulo;
+    std::string base;
+    size_t maxExponentBits = 0;
+    size_t teeth = 0;
+    size_t tables = 0;
+    if (not (stream >> header >> modulo >> base >> maxExponentBits >> teeth >> tables) or header != fileHeader)
+        throw std::runtime_error("Malformed fixed-base table");
+    // Checked before anything is allocated, the counts come from the file
+    if (not validParameters(maxExponentBits, teeth, tables))
+        throw std::runtime_error("Malformed fixed-base table");
+
+    ModContext context{BigInt(modulo)};
+    // Grown as the powers are read, a truncated file stops before its claimed size is reserved
+    std::vector<BigInt> powers;
+    for (size_t count = tables << teeth; powers.size() < count;) {
+        std::string hex;
+        if (not (stream >> hex))
+            throw std::runtime_error("Fixed-base table is truncated");
+        powers.push_back(context.toWorking(BigInt(hex)));
+    }
+    // The first table holds base^1 for the subset of the first row alone
+    if (context.fromWorking(powers[1]) != BigInt(base) % context.getModulo())
+        throw std::runtime_error("Fixed-base table does not belong to its base");
+    return FixedBaseComb(BigInt(base), context, maxExponentBits, teeth, tables, std::move(powers));
+}
+
+const BigInt& FixedBaseComb::getBase() const
+{
+    return _base;
+}
+
+const ModContext& FixedBaseComb::getModContext() const
+{
+    return _context;
+}
+
+size_t FixedBaseComb::maxExponentBits() const
+{
+    return _maxExponentBits;
+}
+
+size_t FixedBaseComb::teeth() const
+{
+    return _teeth;
+}
+
+size_t FixedBaseComb::tables() const
+{
+    return _tables;
+}
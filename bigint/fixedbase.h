@@ -0,0 +1,57 @@
+#ifndef FIXEDBASE_H
+#define FIXEDBASE_H
+
+#include "bigint.h"
+#include "modcontext.h"
+
+#include <iosfwd>
+#include <vector>
+
+// Fixed-base exponentiation base^exponent mod modulo with Lim-Lee comb precomputation.
+// The exponent is cut into `teeth` rows of a = ceil(maxExponentBits / teeth) bits and
+// every row into `tables` blocks of b = ceil(a / tables) columns. One table holds
+// the products of base^(2^(i * a)) for all subsets of rows, the others the same
+// products raised to 2^(j * b). An exponentiation then takes b - 1 squarings and
+// at most tables * b multiplications. The tables keep tables << teeth powers, the empty
+// subsets included. teeth has to be in [1, maxExpTableK] and tables in [1, a],
+// std::logic_error is thrown otherwise.
+// Build once per base (or load from disk) and keep it for all its exponents.
+class FixedBaseComb
+{
+public:
+    FixedBaseComb(const BigInt& base, const ModContext& context, size_t maxExponentBits,
+                  size_t teeth = 6, size_t tables = 2);
+
+    // Exponents longer than maxExponentBits fall back to ModContext::powMod
+    BigInt pow(const BigInt& exponent) const;
+
+    // Text format with hex numbers, independent of the limb width. load throws
+    // std::runtime_error for malformed or truncated tables and for powers of another base.
+    void save(std::ostream& stream) const;
+    static FixedBaseComb load(std::istream& stream);
+
+    const BigInt& getBase() const;
+    const ModContext& getModContext() const;
+    size_t maxExponentBits() const;
+    size_t teeth() const;
+    size_t tables() const;
+
+private:
+    FixedBaseComb(const BigInt& base, const ModContext& context, size_t maxExponentBits,
+                  size_t teeth, size_t tables, std::vector<BigInt>&& powers);
+
+    // Validates the parameters and derives the row and block lengths from them
+    void checkParameters();
+
+    BigInt _base;
+    ModContext _context;
+    size_t _maxExponentBits;
+    size_t _teeth;
+    size_t _tables;
+    size_t _rowBits;
+    size_t _blockBits;
+    // Entry j * 2^teeth + u, in the working representation of _context
+    std::vector<BigInt> _powers;
+};
+
+#endif // FIXEDBASE_H
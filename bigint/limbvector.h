@@ -0,0 +1,253 @@
+#ifndef LIMBVECTOR_H
+#define LIMBVECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+// Contiguous limb storage with room for InlineCapacity limbs inside the object itself.
+// Small numbers never touch the allocator, bigger ones spill to the heap like std::vector.
+// Provides the subset of the std::vector interface the library needs.
+template <typename Limb, size_t InlineCapacity>
+class SmallLimbVector
+{
+public:
+    using value_type = Limb;
+    using iterator = Limb*;
+    using const_iterator = const Limb*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    SmallLimbVector() = default;
+
+    explicit SmallLimbVector(size_t size, Limb value = 0)
+    {
+        resize(size, value);
+    }
+
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    SmallLimbVector(InputIt first, InputIt last)
+    {
+        assign(first, last);
+    }
+
+    SmallLimbVector(const SmallLimbVector& other)
+    {
+        assign(other.begin(), other.end());
+    }
+
+    SmallLimbVector(SmallLimbVector&& other) noexcept
+    {
+        takeFrom(other);
+    }
+
+    SmallLimbVector& operator=(const SmallLimbVector& other)
+    {
+        if (this != &other)
+            assign(other.begin(), other.end());
+        return *this;
+    }
+
+    SmallLimbVector& operator=(SmallLimbVector&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    ~SmallLimbVector()
+    {
+        release();
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    size_t capacity() const
+    {
+        return _capacity;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    bool isInline() const
+    {
+        return _data == _inline;
+    }
+
+    Limb* data()
+    {
+        return _data;
+    }
+
+    const Limb* data() const
+    {
+        return _data;
+    }
+
+    Limb& operator[](size_t index)
+    {
+        return _data[index];
+    }
+
+    const Limb& operator[](size_t index) const
+    {
+        return _data[index];
+    }
+
+    Limb& front()
+    {
+        return _data[0];
+    }
+
+    const Limb& front() const
+    {
+        return _data[0];
+    }
+
+    Limb& back()
+    {
+        return _data[_size - 1];
+    }
+
+    const Limb& back() const
+    {
+        return _data[_size - 1];
+    }
+
+    iterator begin()
+    {
+        return _data;
+    }
+
+    iterator end()
+    {
+        return _data + _size;
+    }
+
+    const_iterator begin() const
+    {
+        return _data;
+    }
+
+    const_iterator end() const
+    {
+        return _data + _size;
+    }
+
+    reverse_iterator rbegin()
+    {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend()
+    {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rbegin() const
+    {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    void reserve(size_t capacity)
+    {
+        if (capacity <= _capacity)
+            return;
+
+        Limb* data = new Limb[capacity];
+        std::copy(_data, _data + _size, data);
+        size_t size = _size;
+        release();
+        _data = data;
+        _size = size;
+        _capacity = capacity;
+    }
+
+    void resize(size_t size, Limb value = 0)
+    {
+        if (size > _capacity)
+            reserve(std::max(size, 2 * _capacity));
+        if (size > _size)
+            std::fill(_data + _size, _data + size, value);
+        _size = size;
+    }
+
+    void assign(size_t size, Limb value)
+    {
+        _size = 0;
+        resize(size, value);
+    }
+
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void assign(InputIt first, InputIt last)
+    {
+        size_t size = static_cast<size_t>(std::distance(first, last));
+        _size = 0;
+        reserve(size);
+        std::copy(first, last, _data);
+        _size = size;
+    }
+
+    void push_back(Limb value)
+    {
+        if (_size == _capacity)
+            reserve(2 * _capacity);
+        _data[_size++] = value;
+    }
+
+    void emplace_back(Limb value)
+    {
+        push_back(value);
+    }
+
+    void clear()
+    {
+        _size = 0;
+    }
+
+private:
+    void release()
+    {
+        if (not isInline())
+            delete[] _data;
+        _data = _inline;
+        _capacity = InlineCapacity;
+        _size = 0;
+    }
+
+    // Heap buffers are stolen, inline ones copied. other is left empty.
+    void takeFrom(SmallLimbVector& other)
+    {
+        if (other.isInline()) {
+            std::copy(other._inline, other._inline + other._size, _inline);
+        } else {
+            _data = other._data;
+            _capacity = other._capacity;
+            other._data = other._inline;
+            other._capacity = InlineCapacity;
+        }
+        _size = other._size;
+        other._size = 0;
+    }
+
+    Limb* _data = _inline;
+    size_t _size = 0;
+    size_t _capacity = InlineCapacity;
+    Limb _inline[InlineCapacity];
+};
+
+#endif // LIMBVECTOR_H
@@ -1,4 +1,7 @@
 #include "bigint.h"
+#include "expschedule.h"
+#include "exptable.h"
+#include "modcontext.h"
 
 #include <iostream>
 
@@ -13,8 +16,8 @@ int main(int argc, const char* argv[])
     poptions::options_description options("Allowed options");
     options.add_options()
             ("help,h", "Prints this message")
-            ("input,i", poptions::value<std::vector<std::string>>(), "Input expression to proceed")
-            ("mode,m", poptions::value<std::string>(), "Input algorighm mode (sw - sliding window, ma - mary alg, lr - binart left-to-right, rl - binart right-to-left)")
+            ("input,i", poptions::value<std::vector<std::string>>(), "Input expression to proceed (a ^ b or a ^ b % m)")
+            ("mode,m", poptions::value<std::string>(), "Input algorighm mode (sw - sliding window, ma - mary alg, lr - binart left-to-right, rl - binart right-to-left, ct - constant time, modular only)")
             ("radix,r", poptions::value<std::string>(), "Input radix for input and output");
 
     poptions::positional_options_description positional;
@@ -40,42 +43,56 @@ int main(int argc, const char* argv[])
             std::string radixMode = variables["radix"].as<std::string>();
             boost::trim(radixMode);
             radix = static_cast<BigInt::Radix>(std::stoul(radixMode, nullptr, 10));
+            if (radix != BigInt::Bin and radix != BigInt::Dec and radix != BigInt::Hex)
+                throw std::logic_error("Unsupported radix");
         }
 
+        if (variables.count("input") == 0)
+            throw std::logic_error("Missing input expression");
+
+        // a ^ b or a ^ b % m
         std::vector<std::string> tokens = variables["input"].as<std::vector<std::string>>();
-        // Additional checkzzz
-        if (tokens.size() != 3)
+        if (tokens.size() != 3 and tokens.size() != 5)
             throw std::logic_error("Malformed input expression");
 
-        if (tokens[1] != "^")
+        if (tokens[1] != "^" or (tokens.size() == 5 and tokens[3] != "%"))
             throw std::logic_error("Malformed input expression");
 
-        size_t lenConstraint = 10;
-        if (radix == BigInt::Dec)
-            lenConstraint = 10;
-        else if (radix == BigInt::Hex)
-            lenConstraint = 8;
-        else if (radix == BigInt::Bin)
-            lenConstraint = 32;
-
-        if (tokens.front().size() > lenConstraint)
-            throw std::logic_error("Exponent can not be that big");
+        std::string mode = "sw";
+        if (variables.count("mode")) {
+            mode = variables["mode"].as<std::string>();
+            boost::trim(mode);
+        }
 
-        std::string mode = variables["mode"].as<std::string>();
-        boost::trim(mode);
         BigInt base(tokens[0], radix);
-        word exp = std::stoul(tokens.back(), nullptr, static_cast<unsigned>(radix));
-
-        if (mode == "sw")
-            std::cout << base.binarySWExp(exp).getStr(radix) << std::endl;
-        else if (mode == "ma")
-            std::cout << base.mAryLRExp(exp).getStr(radix) << std::endl;
-        else if (mode == "lr")
-            std::cout << base.binaryLRExp(exp).getStr(radix) << std::endl;
-        else if (mode == "rl")
-            std::cout << base.binaryRLExp(exp).getStr(radix) << std::endl;
-        else
-            throw std::logic_error("Unknown exponentiation mode");
+        BigInt exp(tokens[2], radix);
+
+        BigInt result;
+        if (tokens.size() == 5) {
+            ModContext context(BigInt(tokens[4], radix));
+            if (mode == "sw")
+                result = context.powMod(base, exp);
+            else if (mode == "ma")
+                result = ExpTable(base, expWindowK(exp.bitsLen(), context.getModulo().wordLen(), ExpWindowMethod::MAry),
+                                  context).mAryLRExp(exp);
+            else if (mode == "ct")
+                result = context.powModConstTime(base, exp);
+            else
+                throw std::logic_error("Unknown modular exponentiation mode");
+        } else {
+            if (mode == "sw")
+                result = base.binarySWExp(exp);
+            else if (mode == "ma")
+                result = base.mAryLRExp(exp);
+            else if (mode == "lr")
+                result = base.binaryLRExp(exp);
+            else if (mode == "rl")
+                result = base.binaryRLExp(exp);
+            else
+                throw std::logic_error("Unknown exponentiation mode");
+        }
+        result.write(std::cout, radix);
+        std::cout << std::endl;
 
     } catch (std::exception& err) {
         std::cerr << err.what() << std::endl;
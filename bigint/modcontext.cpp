@@ -0,0 +1,103 @@
+#include "modcontext.h"
+#include "bigintfunct.h"
+#include "expschedule.h"
+#include "exptable.h"
+
+#include <stdexcept>
+
+ModContext::ModContext(const BigInt& modulo)
+    : _modulo(modulo), _bitsLen(modulo.bitsLen())
+{
+    if (_bitsLen == 0)
+        throw std::logic_error("Modulo can not be zero");
+
+    _barrettMu = divisionRemainder(BigInt(1) << (2 * _bitsLen), _modulo).first;
+    if (_modulo.getBitAt(0))
+        _montgomery.emplace(_modulo);
+    _workingOne = _montgomery ? _montgomery->one() : reduce(1);
+}
+
+BigInt ModContext::reduce(const BigInt& op) const
+{
+    if (op < _modulo)
+        return op;
+
+    if (op.bitsLen() > 2 * _bitsLen)
+        return divisionRemainder(op, _modulo).second;
+
+    // The quotient estimate is at most 2 less than the real one
+    BigInt quotient = ((op >> (_bitsLen - 1)) * _barrettMu) >> (_bitsLen + 1);
+    BigInt remainder = op - quotient * _modulo;
+    while (remainder >= _modulo)
+        remainder = remainder - _modulo;
+    return remainder;
+}
+
+BigInt ModContext::mulMod(const BigInt& left, const BigInt& right) const
+{
+    return reduce(left * right);
+}
+
+BigInt ModContext::sqrMod(const BigInt& op) const
+{
+    return reduce(square(op));
+}
+
+BigInt ModContext::powMod(const BigInt& base, const BigInt& exponent) const
+{
+    return ExpTable(base, expWindowK(exponent.bitsLen(), _modulo.wordLen()), *this).slidingWindowExp(exponent);
+}
+
+BigInt ModContext::powModConstTime(const BigInt& base, const BigInt& exponent) const
+{
+    if (not _montgomery)
+        throw std::logic_error("Constant-time exponentiation needs an odd modulo");
+
+    return _montgomery->powConstTime(base, exponent);
+}
+
+BigInt ModContext::toWorking(const BigInt& op) const
+{
+    return _montgomery ? _montgomery->toMontgomery(op) : reduce(op);
+}
+
+BigInt ModContext::fromWorking(const BigInt& op) const
+{
+    return _montgomery ? _montgomery->fromMontgomery(op) : op;
+}
+
+const BigInt& ModContext::workingOne() const
+{
+    return _workingOne;
+}
+
+void ModContext::mulWorking(BigInt& result, const BigInt& left, const BigInt& right) const
+{
+    if (_montgomery)
+        _montgomery->multiply(result, left, right);
+    else
+        result = mulMod(left, right);
+}
+
+void ModContext::sqrWorking(BigInt& result, const BigInt& op) const
+{
+    if (_montgomery)
+        _montgomery->square(result, op);
+    else
+        result = sqrMod(op);
+}
+
+const BigInt& ModContext::getModulo() const
+{
+    return _modulo;
+}
+
+size_t ModContext::bitsLen() const
+{
+    return _bitsLen;
+}
+
+const std::optional<Montgomery>& ModContext::getMontgomery() const
+{
+    return _montgomery;
+}
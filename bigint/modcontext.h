@@ -0,0 +1,50 @@
+#ifndef MODCONTEXT_H
+#define MODCONTEXT_H
+
+#include "bigint.h"
+#include "montgomery.h"
+
+#include <optional>
+#include <vector>
+
+// Everything which depends on the modulo only: its bit length, Barrett constant
+// mu = floor(2^(2 * bitsLen) / modulo) and, for odd moduli, the Montgomery context.
+// Build it once and keep it for as long as the modulo lives to reduce against it cheaply.
+class ModContext
+{
+public:
+    explicit ModContext(const BigInt& modulo);
+
+    // Barrett reduction, inputs up to 2 * bitsLen() bits long are reduced without division
+    BigInt reduce(const BigInt& op) const;
+    BigInt mulMod(const BigInt& left, const BigInt& right) const;
+    BigInt sqrMod(const BigInt& op) const;
+    BigInt powMod(const BigInt& base, const BigInt& exponent) const;
+    // prod bases[i]^exponents[i] mod modulo over one shared squaring chain: interleaved windows
+    // (Straus) for a few terms, Pippenger's bucket method for large batches
+    BigInt multiExp(const std::vector<BigInt>& bases, const std::vector<BigInt>& exponents) const;
+    // Constant-time exponentiation for secret exponents, odd moduli only (see Montgomery::powConstTime)
+    BigInt powModConstTime(const BigInt& base, const BigInt& exponent) const;
+
+    // Working representation of the exponentiations: Montgomery form for odd moduli,
+    // reduced residues otherwise. Products in it need no conversion in between.
+    BigInt toWorking(const BigInt& op) const;
+    BigInt fromWorking(const BigInt& op) const;
+    const BigInt& workingOne() const;
+    void mulWorking(BigInt& result, const BigInt& left, const BigInt& right) const;
+    void sqrWorking(BigInt& result, const BigInt& op) const;
+
+    const BigInt& getModulo() const;
+    size_t bitsLen() const;
+    // Present for odd moduli only
+    const std::optional<Montgomery>& getMontgomery() const;
+
+private:
+    BigInt _modulo;
+    size_t _bitsLen;
+    BigInt _barrettMu;
+    std::optional<Montgomery> _montgomery;
+    BigInt _workingOne;
+};
+
+#endif // MODCONTEXT_H
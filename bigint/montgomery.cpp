@@ -0,0 +1,147 @@
+#include "montgomery.h"
+#include "bigintfunct.h"
+#include "bigintkernel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+Montgomery::Montgomery(const BigInt& modulo)
+    : _modulo(modulo)
+{
+    if (modulo.bitsLen() == 0 or not modulo.getBitAt(0))
+        throw std::logic_error("Montgomery arithmetic needs an odd modulo");
+
+    _len = _modulo.wordLen();
+
+    // Newton iteration for modulo^-1 mod 2^bitsInWord. Any odd n is its own inverse
+    // modulo 8 and every step doubles the number of correct low bits.
+    word lowWord = _modulo.getHeap().front();
+    word inverse = lowWord;
+    for (size_t correctBits = 3; correctBits < bitsInWord; correctBits *= 2)
+        inverse *= 2 - lowWord * inverse;
+    _modInverse = word(0) - inverse;
+
+    _rModN = divisionRemainder(BigInt(1) << (_len * bitsInWord), _modulo).second;
+    _r2ModN = divisionRemainder(_rModN * _rModN, _modulo).second;
+}
+
+BigInt Montgomery::toMontgomery(const BigInt& value) const
+{
+    if (value >= _modulo)
+        return multiply(divisionRemainder(value, _modulo).second, _r2ModN);
+    return multiply(value, _r2ModN);
+}
+
+BigInt Montgomery::fromMontgomery(const BigInt& value) const
+{
+    return multiply(value, 1);
+}
+
+BigInt Montgomery::multiply(const BigInt& left, const BigInt& right) const
+{
+    BigInt result;
+    multiply(result, left, right);
+    return result;
+}
+
+BigInt Montgomery::square(const BigInt& op) const
+{
+    BigInt result;
+    square(result, op);
+    return result;
+}
+
+// Operands are padded into per-thread buffers, which keeps the loops of powMod free of allocations
+void Montgomery::multiply(BigInt& result, const BigInt& left, const BigInt& right) const
+{
+    static thread_local std::vector<word> leftHeap;
+    static thread_local std::vector<word> rightHeap;
+    static thread_local std::vector<word> scratch;
+    pad(leftHeap, left);
+    pad(rightHeap, right);
+    scratch.resize(_len + 2);
+    result.assignWords(_len, [this](word* heap) {
+        montgomeryMulWords(heap, leftHeap.data(), rightHeap.data(),
+                           _modulo.getHeap().data(), _len, _modInverse, scratch.data());
+    });
+}
+
+void Montgomery::square(BigInt& result, const BigInt& op) const
+{
+    static thread_local std::vector<word> opHeap;
+    static thread_local std::vector<word> product;
+    pad(opHeap, op);
+    product.assign(2 * _len + 1, 0);
+    sqrWords(product.data(), opHeap.data(), _len);
+    result.assignWords(_len, [this](word* heap) {
+        montgomeryReduceWords(heap, product.data(), _modulo.getHeap().data(), _len, _modInverse);
+    });
+}
+
+BigInt Montgomery::powConstTime(const BigInt& base, const BigInt& exponent) const
+{
+    constexpr size_t windowBits = 5;
+    constexpr size_t tableSize = size_t(1) << windowBits;
+    const word* modulo = _modulo.getHeap().data();
+
+    std::vector<word> scratch(_len + 2);
+    std::vector<word> baseHeap;
+    std::vector<word> power;
+    pad(baseHeap, toMontgomery(base));
+    pad(power, _rModN);
+
+    std::vector<word> table(tableSize * _len);
+    scatterWords(table.data(), tableSize, 0, power.data(), _len);
+    for (size_t i = 1; i < tableSize; ++i) {
+        montgomeryMulWords(power.data(), power.data(), baseHeap.data(), modulo, _len, _modInverse, scratch.data());
+        scatterWords(table.data(), tableSize, i, power.data(), _len);
+    }
+
+    // The exponent is zero-extended to at least the modulo length, so that
+    // the number of windows does not depend on its leading zero bits
+    size_t exponentLen = std::max(normalizedLen(exponent.getHeap().data(), exponent.wordLen()), _len);
+    std::vector<word> exponentHeap(exponent.getHeap().begin(), exponent.getHeap().end());
+    exponentHeap.resize(exponentLen, 0);
+
+    std::vector<word> result;
+    std::vector<word> entry(_len);
+    pad(result, _rModN);
+    size_t windowsCount = (exponentLen * bitsInWord + windowBits - 1) / windowBits;
+    for (size_t window = windowsCount; window > 0; --window) {
+        for (size_t i = 0; i < windowBits; ++i)
+            montgomeryMulWords(result.data(), result.data(), result.data(), modulo, _len, _modInverse, scratch.data());
+
+        size_t from = (window - 1) * windowBits;
+        size_t wordNum = from / bitsInWord;
+        size_t offset = from % bitsInWord;
+        word index = exponentHeap[wordNum] >> offset;
+        if (offset + windowBits > bitsInWord and wordNum + 1 < exponentLen)
+            index |= exponentHeap[wordNum + 1] << (bitsInWord - offset);
+        index &= tableSize - 1;
+
+        gatherWords(entry.data(), table.data(), tableSize, index, _len);
+        montgomeryMulWords(result.data(), result.data(), entry.data(), modulo, _len, _modInverse, scratch.data());
+    }
+
+    std::fill(entry.begin(), entry.end(), word(0));
+    entry.front() = 1;
+    montgomeryMulWords(result.data(), result.data(), entry.data(), modulo, _len, _modInverse, scratch.data());
+    return BigInt(std::move(result));
+}
+
+const BigInt& Montgomery::one() const
+{
+    return _rModN;
+}
+
+const BigInt& Montgomery::getModulo() const
+{
+    return _modulo;
+}
+
+void Montgomery::pad(std::vector<word>& buffer, const BigInt& op) const
+{
+    size_t len = std::min(op.wordLen(), _len);
+    buffer.assign(op.getHeap().begin(), op.getHeap().begin() + len);
+    buffer.resize(_len, 0);
+}
@@ -0,0 +1,46 @@
+#ifndef MONTGOMERY_H
+#define MONTGOMERY_H
+
+#include "bigint.h"
+
+// Precomputed context for Montgomery arithmetic modulo an odd number n.
+// Values are kept in Montgomery representation x * R mod n, where R = 2^(bitsInWord * len)
+// and len is the number of words of n. Multiplication then needs no division at all.
+class Montgomery
+{
+public:
+    explicit Montgomery(const BigInt& modulo);
+
+    BigInt toMontgomery(const BigInt& value) const;
+    BigInt fromMontgomery(const BigInt& value) const;
+
+    // Both operands and the result are in Montgomery representation, so below n.
+    // Longer operands are truncated to the word length of n, not reduced.
+    BigInt multiply(const BigInt& left, const BigInt& right) const;
+    BigInt square(const BigInt& op) const;
+    // Destination-passing forms for exponentiation loops, result may be one of the operands
+    void multiply(BigInt& result, const BigInt& left, const BigInt& right) const;
+    void square(BigInt& result, const BigInt& op) const;
+
+    // base^exponent mod n for secret exponents, plain representation in and out.
+    // Fixed 5-bit windows with masked table lookups: the sequence of operations and the memory
+    // accesses depend on the modulo length and the exponent word length only.
+    BigInt powConstTime(const BigInt& base, const BigInt& exponent) const;
+
+    // 1 in Montgomery representation (R mod n)
+    const BigInt& one() const;
+    const BigInt& getModulo() const;
+
+private:
+    // Copies op into buffer zero-extended to the modulo length. op has to be below n,
+    // words above the modulo length are dropped.
+    void pad(std::vector<word>& buffer, const BigInt& op) const;
+
+    BigInt _modulo;
+    BigInt _rModN;
+    BigInt _r2ModN;
+    word _modInverse;
+    size_t _len;
+};
+
+#endif // MONTGOMERY_H
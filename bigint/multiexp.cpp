@@ -0,0 +1,129 @@
+#include "modcontext.h"
+#include "expschedule.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+// Above this many terms the buckets of Pippenger's method beat per-base tables
+constexpr size_t pippengerThreshold = 32;
+
+static size_t maxBitsLen(const std::vector<BigInt>& exponents)
+{
+    size_t result = 0;
+    for (const BigInt& exponent : exponents)
+        result = std::max(result, exponent.bitsLen());
+    return result;
+}
+
+// Straus: a table of 2^k powers per base and one squaring chain for all of them,
+// every window then costs one multiplication per base
+static BigInt strausMultiExp(const ModContext& context, const std::vector<BigInt>& bases,
+                             const std::vector<BigInt>& exponents, size_t bitsLen)
+{
+    word k = bitsLen <= 64 ? 2 : (bitsLen <= 512 ? 3 : 4);
+    auto multiply = [&context](BigInt& result, const BigInt& left, const BigInt& right) {
+        context.mulWorking(result, left, right);
+    };
+
+    std::vector<std::vector<BigInt>> tables;
+    tables.reserve(bases.size());
+    for (const BigInt& base : bases)
+        tables.push_back(expTableSchedule(context.toWorking(base), context.workingOne(), k, multiply));
+
+    BigInt result = context.workingOne();
+    size_t windowsCount = (bitsLen + k - 1) / k;
+    for (size_t window = windowsCount; window > 0; --window) {
+        if (window != windowsCount) {
+            for (word i = 0; i < k; ++i)
+                context.sqrWorking(result, result);
+        }
+
+        for (size_t i = 0; i < bases.size(); ++i) {
+            word digit = exponentWindow(exponents[i], (window - 1) * k, k);
+            if (digit != 0)
+                context.mulWorking(result, result, tables[i][digit]);
+        }
+    }
+    return result;
+}
+
+// Pippenger: per window every base goes into the bucket of its digit d with one
+// multiplication, then prod B_d^d is collected with two multiplications per bucket
+static BigInt pippengerMultiExp(const ModContext& context, const std::vector<BigInt>& bases,
+                                const std::vector<BigInt>& exponents, size_t bitsLen)
+{
+    size_t log2Count = 0;
+    while ((size_t(2) << log2Count) <= bases.size())
+        ++log2Count;
+    size_t k = std::clamp(log2Count, size_t(4), size_t(16)) - 2;
+
+    std::vector<BigInt> workingBases;
+    workingBases.reserve(bases.size());
+    for (const BigInt& base : bases)
+        workingBases.push_back(context.toWorking(base));
+
+    size_t bucketsCount = size_t(1) << k;
+    std::vector<BigInt> buckets(bucketsCount);
+    std::vector<bool> filled(bucketsCount);
+    BigInt result = context.workingOne();
+    BigInt running;
+    BigInt windowProduct;
+    size_t windowsCount = (bitsLen + k - 1) / k;
+    for (size_t window = windowsCount; window > 0; --window) {
+        if (window != windowsCount) {
+            for (size_t i = 0; i < k; ++i)
+                context.sqrWorking(result, result);
+        }
+
+        std::fill(filled.begin(), filled.end(), false);
+        for (size_t i = 0; i < workingBases.size(); ++i) {
+            word digit = exponentWindow(exponents[i], (window - 1) * k, k);
+            if (digit == 0)
+                continue;
+            if (filled[digit]) {
+                context.mulWorking(buckets[digit], buckets[digit], workingBases[i]);
+            } else {
+                buckets[digit] = workingBases[i];
+                filled[digit] = true;
+            }
+        }
+
+        // running = prod of B_e for e >= d, so prod of running over all d is prod B_d^d
+        bool runningStarted = false;
+        bool productStarted = false;
+        for (size_t digit = bucketsCount - 1; digit > 0; --digit) {
+            if (filled[digit]) {
+                if (runningStarted)
+                    context.mulWorking(running, running, buckets[digit]);
+                else
+                    running = buckets[digit];
+                runningStarted = true;
+            }
+            if (not runningStarted)
+                continue;
+
+            if (productStarted)
+                context.mulWorking(windowProduct, windowProduct, running);
+            else
+                windowProduct = running;
+            productStarted = true;
+        }
+        if (productStarted)
+            context.mulWorking(result, result, windowProduct);
+    }
+    return result;
+}
+
+BigInt ModContext::multiExp(const std::vector<BigInt>& bases, const std::vector<BigInt>& exponents) const
+{
+    if (bases.size() != exponents.size())
+        throw std::logic_error("Every base needs its exponent");
+
+    size_t bitsLen = maxBitsLen(exponents);
+    if (bitsLen == 0)
+        return reduce(1);
+
+    BigInt result = bases.size() < pippengerThreshold ? strausMultiExp(*this, bases, exponents, bitsLen)
+                                                      : pippengerMultiExp(*this, bases, exponents, bitsLen);
+    return fromWorking(result);
+}
@@ -0,0 +1,305 @@
+#include "bbs.h"
+#include "bigintfunct.h"
+#include "gost.h"
+#include "primality.h"
+
+#include <gtest/gtest.h>
+
+#include <gmpxx.h>
+
+#include <random>
+#include <vector>
+
+TEST(Primality, SmallNumbers)
+{
+    constexpr uint64_t limit = 100000;
+    std::vector<bool> composite(limit, false);
+    for (uint64_t i = 0; i < limit; ++i) {
+        bool prime = i >= 2 and not composite[i];
+        if (prime) {
+            for (uint64_t j = i * i; j < limit; j += i)
+                composite[j] = true;
+        }
+        ASSERT_EQ(prime, isPrime(i)) << i;
+        ASSERT_EQ(prime, isProbablePrime(BigInt(static_cast<word>(i)))) << i;
+    }
+    EXPECT_EQ(smallPrimes().size(), 6542u);
+    EXPECT_EQ(smallPrimes().back(), 65521u);
+}
+
+TEST(Primality, Pseudoprimes)
+{
+    // Carmichael numbers, strong pseudoprimes to base 2 and strong Lucas pseudoprimes
+    for (uint64_t composite : {561ull, 41041ull, 825265ull, 321197185ull, 2047ull, 3277ull, 4033ull,
+                               3215031751ull, 5459ull, 5777ull, 10877ull, 16109ull, 18971ull,
+                               3825123056546413051ull}) {
+        EXPECT_FALSE(isPrime(composite)) << composite;
+        EXPECT_FALSE(isProbablePrime(BigInt(std::to_string(composite), BigInt::Dec))) << composite;
+    }
+
+    // Strong pseudoprime to all prime bases up to 37 (Arnault), caught by the Lucas test
+    BigInt arnault("318665857834031151167461", BigInt::Dec);
+    EXPECT_FALSE(isProbablePrime(arnault));
+    // The two tests of BPSW have no common small pseudoprime
+    for (word lucasPseudoprime : {5459, 5777, 10877, 16109, 18971}) {
+        EXPECT_TRUE(strongLucasTest(lucasPseudoprime)) << lucasPseudoprime;
+        EXPECT_FALSE(millerRabinTest(ModContext(lucasPseudoprime), 2)) << lucasPseudoprime;
+    }
+    for (word basePseudoprime : {2047, 3277, 4033, 4681, 8321}) {
+        EXPECT_TRUE(millerRabinTest(ModContext(basePseudoprime), 2)) << basePseudoprime;
+        EXPECT_FALSE(strongLucasTest(basePseudoprime)) << basePseudoprime;
+    }
+
+    EXPECT_TRUE(isPrime(18446744073709551557ull));
+    EXPECT_FALSE(isPrime(18446744073709551615ull));
+}
+
+TEST(Primality, BigNumbers)
+{
+    // Mersenne primes and the composites around them
+    for (size_t exponent : {61, 89, 107, 127, 521, 607, 1279}) {
+        BigInt mersenne = (BigInt(1) << exponent) - 1;
+        EXPECT_TRUE(isProbablePrime(mersenne)) << exponent;
+        EXPECT_FALSE(isProbablePrime(mersenne + 2)) << exponent;
+        EXPECT_FALSE(isProbablePrime(mersenne * mersenne)) << exponent;
+    }
+
+    gmp_randclass randomMachine(gmp_randinit_default);
+    std::default_random_engine gen;
+    std::uniform_int_distribution<size_t> distr(65, 1024);
+    for (size_t i = 0; i < 300; ++i) {
+        mpz_class candidate = randomMachine.get_z_bits(distr(gen)) | 1;
+        if (i % 2 == 0)
+            mpz_nextprime(candidate.get_mpz_t(), candidate.get_mpz_t());
+        bool expected = mpz_probab_prime_p(candidate.get_mpz_t(), 30) != 0;
+        ASSERT_EQ(expected, isProbablePrime(BigInt(candidate.get_str(16)))) << candidate.get_str(16);
+    }
+
+    // Products of two big primes
+    mpz_class p = randomMachine.get_z_bits(512);
+    mpz_class q = randomMachine.get_z_bits(512);
+    mpz_nextprime(p.get_mpz_t(), p.get_mpz_t());
+    mpz_nextprime(q.get_mpz_t(), q.get_mpz_t());
+    mpz_class product = p * q;
+    EXPECT_TRUE(isProbablePrime(BigInt(p.get_str(16))));
+    EXPECT_FALSE(isProbablePrime(BigInt(product.get_str(16))));
+    EXPECT_FALSE(strongLucasTest(BigInt(product.get_str(16))));
+}
+
+TEST(PrimeSearch, NextPrime)
+{
+    gmp_randclass randomMachine(gmp_randinit_default);
+    for (size_t nBits : {20, 40, 64, 100, 256, 700}) {
+        mpz_class start = randomMachine.get_z_bits(nBits) | 1;
+        mpz_class expected;
+        mpz_nextprime(expected.get_mpz_t(), start.get_mpz_t());
+        BigInt limit = BigInt(1) << (nBits + 1);
+        std::optional<BigInt> prime = searchPrime(BigInt(start.get_str(16)), 2, limit);
+        ASSERT_TRUE(prime.has_value()) << nBits;
+        EXPECT_EQ(prime->getStr(BigInt::Hex), expected.get_str(16)) << nBits;
+    }
+
+    // Nothing between a prime and the next one
+    BigInt prime = (BigInt(1) << 127) - 1;
+    EXPECT_FALSE(searchPrime(prime + 2, 2, prime + 2 * 7).has_value());
+    EXPECT_THROW(searchPrime(4, 2, 100), std::logic_error);
+}
+
+TEST(PrimeSearch, Congruences)
+{
+    std::default_random_engine gen;
+    for (size_t nBits : {2, 3, 17, 64, 65, 256, 1024}) {
+        BigInt prime = blumsPrime(nBits);
+        EXPECT_EQ(prime.bitsLen(), nBits);
+        EXPECT_TRUE(isProbablePrime(prime));
+        EXPECT_EQ(prime.getHeap()[0] & 3, 3u);
+    }
+    EXPECT_EQ(blumsPrime(5), BigInt(19));
+    EXPECT_EQ(blumsPrime(17), BigInt(65539));
+
+    for (size_t nBits : {16, 100, 512}) {
+        BigInt prime = randomPrime(nBits, PrimeKind::Blum, gen);
+        EXPECT_EQ(prime.bitsLen(), nBits);
+        EXPECT_TRUE(isProbablePrime(prime));
+        EXPECT_EQ(prime.getHeap()[0] & 3, 3u);
+    }
+
+    for (size_t nBits : {10, 64, 256}) {
+        BigInt prime = randomPrime(nBits, PrimeKind::Safe, gen);
+        EXPECT_EQ(prime.bitsLen(), nBits);
+        EXPECT_TRUE(isProbablePrime(prime));
+        EXPECT_TRUE(isProbablePrime(prime >> 1));
+    }
+
+    // p = 1 (mod 2q)
+    BigInt q = blumsPrime(160);
+    BigInt start = (BigInt(1) << 511) - divisionRemainder(BigInt(1) << 511, q << 1).second + 1;
+    BigInt p = *searchPrime(start, q << 1, BigInt(1) << 512);
+    EXPECT_TRUE(isProbablePrime(p));
+    EXPECT_EQ(divisionRemainder(p - 1, q << 1).second, BigInt(0));
+}
+
+TEST(PrimeSearch, GOST)
+{
+    GOST generator;
+    for (word nBits : {17, 33, 128, 512}) {
+        BigInt prime = generator.getRandomBits(nBits);
+        EXPECT_EQ(prime.bitsLen(), nBits);
+        EXPECT_TRUE(isProbablePrime(prime)) << prime.getStr(BigInt::Hex);
+    }
+    EXPECT_THROW(generator.getRandomBits(16), std::logic_error);
+
+    // The least primes of 8 to 16 bits the procedure starts from
+    EXPECT_EQ(*searchPrime((BigInt(1) << 7) + 1, 2, BigInt(1) << 8), BigInt(131));
+    EXPECT_EQ(*searchPrime((BigInt(1) << 15) + 1, 2, BigInt(1) << 16), BigInt(32771));
+}
+
+TEST(PrimeSearch, Parallel)
+{
+    std::default_random_engine gen;
+    for (size_t nBits : {64, 300, 1024}) {
+        BigInt start = randomBits(nBits, gen);
+        start.setBitAt(0, true);
+        start.setBitAt(1, true);
+        BigInt limit = BigInt(1) << nBits;
+        std::optional<BigInt> expected = searchPrime(start, 4, limit);
+        for (size_t threads : {2, 3, 8}) {
+            std::optional<BigInt> prime = searchPrimeParallel(start, 4, limit, threads);
+            ASSERT_EQ(prime.has_value(), expected.has_value()) << nBits;
+            if (expected) {
+                EXPECT_EQ(*prime, *expected) << nBits << " " << threads;
+            }
+        }
+    }
+
+    BigInt safe = *searchPrimeParallel((BigInt(1) << 127) + 3, 4, BigInt(1) << 128, 4, true);
+    EXPECT_EQ(safe, *searchPrime((BigInt(1) << 127) + 3, 4, BigInt(1) << 128, true));
+    BigInt prime = (BigInt(1) << 127) - 1;
+    EXPECT_FALSE(searchPrimeParallel(prime + 2, 2, prime + 2 * 7, 4).has_value());
+
+    // Exceptions of the test reach the caller
+    auto failing = [](const BigInt&) -> bool { throw std::runtime_error("Test failed"); };
+    EXPECT_THROW(searchPrimeParallel((BigInt(1) << 100) + 1, 2, BigInt(1) << 101, 4, false, failing),
+                 std::runtime_error);
+
+    auto [p, q] = randomPrimePair(256, 200, PrimeKind::Blum, gen, 4);
+    EXPECT_EQ(p.bitsLen(), 256u);
+    EXPECT_EQ(q.bitsLen(), 200u);
+    EXPECT_TRUE(isProbablePrime(p));
+    EXPECT_TRUE(isProbablePrime(q));
+    auto [first, second] = randomPrimePair(256, 256, PrimeKind::Any, gen, 2);
+    EXPECT_NE(first, second);
+}
+
+TEST(BBS, Stream)
+{
+    // Reference steps of x -> x^2 mod n through GMP
+    BigInt p = blumsPrime(256);
+    BigInt q = blumsPrime(300);
+    BigInt seed("123456789abcdef0123456789abcdef");
+    BBS generator(p, q, seed);
+    EXPECT_EQ(generator.bitsPerStep(), 9u);
+    EXPECT_EQ(generator.getModulo(), p * q);
+
+    mpz_class n(generator.getModulo().getStr(BigInt::Hex), 16);
+    mpz_class x(seed.getStr(BigInt::Hex), 16);
+    x = x * x % n;
+    auto step = [&]() {
+        x = x * x % n;
+        return mpz_class(x & 0x1ff).get_ui();
+    };
+    for (size_t i = 0; i < 100; ++i)
+        ASSERT_EQ(generator.getRandomBits(), BigInt(static_cast<word>(step()))) << i;
+
+    // Bytes are packed from the lowest bit, split buffers continue the same stream
+    std::vector<uint8_t> bytes(1000);
+    generator.generate(bytes.data(), 1);
+    generator.generate(bytes.data() + 1, 400);
+    generator.generate(bytes.data() + 401, bytes.size() - 401);
+    mpz_class bits = 0;
+    for (size_t i = 0; i * 9 < bytes.size() * 8; ++i)
+        bits |= mpz_class(step()) << (9 * i);
+    for (size_t i = 0; i < bytes.size(); ++i)
+        ASSERT_EQ(bytes[i], mpz_class((bits >> (8 * i)) & 0xff).get_ui()) << i;
+}
+
+TEST(BBS, KeyGeneration)
+{
+    BBS generator(512);
+    EXPECT_EQ(generator.getModulo().bitsLen(), 512u);
+    // floor(log2(log2(n))) for 2^511 <= n < 2^512
+    EXPECT_EQ(generator.bitsPerStep(), 8u);
+    for (size_t i = 0; i < 10; ++i)
+        EXPECT_LT(generator.getRandomBits(), BigInt(1 << 8));
+    EXPECT_EQ(BBS(blumsPrime(256), blumsPrime(257)).bitsPerStep(), 8u);
+    EXPECT_EQ(BBS(blumsPrime(256), blumsPrime(258)).bitsPerStep(), 9u);
+
+    // Products of the random primes never fall short of a bit
+    std::random_device rd;
+    for (size_t i = 0; i < 20; ++i) {
+        auto [p, q] = randomPrimePair(40, 41, PrimeKind::Blum, rd, 2);
+        EXPECT_EQ((p * q).bitsLen(), 81u);
+    }
+
+    EXPECT_THROW(BBS(blumsPrime(64), BigInt(1) << 64), std::logic_error);
+    EXPECT_THROW(BBS(blumsPrime(64), blumsPrime(65), blumsPrime(64)), std::logic_error);
+    EXPECT_THROW(BBS(8), std::logic_error);
+    // Factors are checked before a seed is searched, there is none modulo 1
+    EXPECT_THROW(BBS(BigInt(1), BigInt(1)), std::logic_error);
+    EXPECT_THROW(BBS(BigInt(3), BigInt(3)), std::logic_error);
+    // Equal and composite factors would break lambda(n) and with it seek()
+    EXPECT_THROW(BBS(blumsPrime(64), blumsPrime(64)), std::logic_error);
+    EXPECT_THROW(BBS(blumsPrime(64), blumsPrime(64), 5), std::logic_error);
+    // Products of three Blum primes are 3 modulo 4 as well
+    BigInt composite = blumsPrime(32) * blumsPrime(33) * blumsPrime(20);
+    ASSERT_EQ(composite.getHeap()[0] & 3, 3u);
+    EXPECT_THROW(BBS(blumsPrime(64), composite), std::logic_error);
+    EXPECT_THROW(BBS(BigInt(3) * 7 * 11, blumsPrime(64)), std::logic_error);
+}
+
+TEST(BBS, Seek)
+{
+    BBS generator(blumsPrime(200), blumsPrime(230), BigInt("fedcba9876543210"));
+    std::vector<BigInt> outputs;
+    for (size_t i = 0; i < 300; ++i)
+        outputs.push_back(generator.getRandomBits());
+    EXPECT_EQ(generator.position(), 300u);
+
+    for (uint64_t step : {0, 1, 7, 150, 299, 13}) {
+        generator.seek(step);
+        EXPECT_EQ(generator.position(), step);
+        EXPECT_EQ(generator.getRandomBits(), outputs[step]) << step;
+    }
+
+    // Steps far away agree with the sequential stream from the point reached by seeking
+    BBS jumped = generator;
+    jumped.seek(uint64_t(1) << 40);
+    generator.seek((uint64_t(1) << 40) - 5);
+    for (size_t i = 0; i < 5; ++i)
+        generator.getRandomBits();
+    EXPECT_EQ(jumped.getRandomBits(), generator.getRandomBits());
+}
+
+TEST(BBS, ParallelStream)
+{
+    BBS sequential(blumsPrime(256), blumsPrime(257), BigInt("1234567"));
+    BBS parallel = sequential;
+    ASSERT_EQ(sequential.bitsPerStep(), 8u);
+    BBS oddSequential(blumsPrime(128), blumsPrime(129), BigInt("1234567"));
+    BBS oddParallel = oddSequential;
+    ASSERT_EQ(oddSequential.bitsPerStep(), 7u);
+
+    // Buffers of every size, starting in the middle of a step as well
+    for (size_t size : {3, 5000, 10007, 20000}) {
+        for (size_t threads : {2, 3, 4}) {
+            std::vector<uint8_t> expected(size), bytes(size);
+            sequential.generate(expected.data(), size);
+            parallel.generate(bytes.data(), size, threads);
+            ASSERT_EQ(bytes, expected) << size << " " << threads;
+            oddSequential.generate(expected.data(), size);
+            oddParallel.generate(bytes.data(), size, threads);
+            ASSERT_EQ(bytes, expected) << size << " " << threads;
+        }
+    }
+    EXPECT_EQ(oddParallel.getRandomBits(), oddSequential.getRandomBits());
+}
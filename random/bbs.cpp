@@ -1,38 +1,178 @@
 #include "bbs.h"
+#include "primality.h"
 
-BBS::BBS(word nBits)
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+static std::pair<BigInt, BigInt> randomFactors(word nBits)
 {
+    if (nBits < 16)
+        throw std::logic_error("BBS modulo is too small");
+
+    // Key material comes straight from the operating system's random source, a seeded
+    // engine would leave no more possible keys than it has seeds
     std::random_device rd;
-    std::default_random_engine gen{rd()};
-    std::uniform_int_distribution<word> distr(0, maxWord);
-    BigInt p = getRandSeed(std::floor(nBits / 2), distr, gen);
-    BigInt q = getRandSeed(std::floor(nBits / 2), distr, gen);
-    _modulo = p * q;
-    _state = getRandSeed(nBits, distr, gen);
+    // n = p * q of two distinct Blum primes, searched at once. Their two top bits are set,
+    // so n has exactly nBits bits.
+    auto [p, q] = randomPrimePair(nBits / 2, nBits - nBits / 2, PrimeKind::Blum, rd);
+    while (p == q)
+        std::tie(p, q) = randomPrimePair(nBits / 2, nBits - nBits / 2, PrimeKind::Blum, rd);
+    return {p, q};
+}
+
+// lambda(n) and with it seek() hold for n = p * q of distinct primes only. Checked before
+// anything is done with n, a seed search modulo 1 would never end.
+static BigInt checkedModulo(const BigInt& p, const BigInt& q)
+{
+    for (const BigInt* prime : {&p, &q}) {
+        if ((prime->getHeap()[0] & 3) != 3 or not isProbablePrime(*prime))
+            throw std::logic_error("BBS factors have to be primes equal to 3 modulo 4");
+    }
+    if (p == q)
+        throw std::logic_error("BBS factors have to be distinct");
+    return p * q;
 }
 
-BBS::BBS(BigInt p, BigInt q, word nBits)
+// Random x in [2, n) coprime to n
+static BigInt randomSeed(const BigInt& modulo)
 {
     std::random_device rd;
-    std::default_random_engine gen{rd()};
-    std::uniform_int_distribution<word> distr(0, maxWord);
-    _modulo = p * q;
-    _state = getRandSeed(nBits, distr, gen);
+    while (true) {
+        BigInt x = randomBits(modulo.bitsLen(), rd) % modulo;
+        if (x > 1 and gcd(x, modulo) == 1)
+            return x;
+    }
+}
+
+// floor(log2(log2(n))), at least one bit. log2(n) is in [bitsLen - 1, bitsLen),
+// so this is floor(log2(bitsLen - 1)).
+static size_t securedBits(const BigInt& modulo)
+{
+    size_t result = 0;
+    for (size_t bits = modulo.bitsLen() - 1; bits > 1; bits >>= 1)
+        ++result;
+    return std::max<size_t>(result, 1);
+}
+
+BBS::BBS(word nBits)
+    : BBS(randomFactors(nBits))
+{
+}
+
+BBS::BBS(const std::pair<BigInt, BigInt>& factors)
+    : BBS(factors.first, factors.second)
+{
+}
+
+BBS::BBS(const BigInt& p, const BigInt& q)
+    : BBS(p, q, randomSeed(checkedModulo(p, q)))
+{
+}
+
+BBS::BBS(const BigInt& p, const BigInt& q, const BigInt& seed)
+    : _modulo(checkedModulo(p, q))
+    , _bitsPerStep(securedBits(_modulo.getModulo()))
+{
+    if (gcd(seed, _modulo.getModulo()) != 1)
+        throw std::logic_error("BBS seed has to be coprime to the modulo");
+
+    BigInt pMinusOne = p - 1;
+    BigInt qMinusOne = q - 1;
+    _carmichael = divisionRemainder(pMinusOne * qMinusOne, gcd(pMinusOne, qMinusOne)).first;
+    // x_0 = seed^2 mod n is a quadratic residue
+    _seed = _modulo.sqrMod(_modulo.reduce(seed));
+    _state = _modulo.toWorking(_seed);
+}
+
+word BBS::nextBits()
+{
+    // The state stays in the working representation, only its low word is taken out of it
+    _modulo.sqrWorking(_state, _state);
+    ++_position;
+    word low = _modulo.fromWorking(_state).getHeap()[0];
+    return low & (maxWord >> (bitsInWord - _bitsPerStep));
 }
 
 BigInt BBS::getRandomBits()
 {
-    _state = _state.binarySWExp(2);
-    _state = _state % _modulo;
-    return _state;
+    return nextBits();
+}
+
+void BBS::generate(uint8_t* data, size_t size)
+{
+    // Bits go through a 64-bit accumulator, bitsPerStep() of any modulo that fits in memory
+    // is far below the 56 bits it has room for
+    for (size_t i = 0; i < size; ++i) {
+        while (_pendingBits < 8) {
+            _pending |= static_cast<uint64_t>(nextBits()) << _pendingBits;
+            _pendingBits += _bitsPerStep;
+        }
+        data[i] = static_cast<uint8_t>(_pending);
+        _pending >>= 8;
+        _pendingBits -= 8;
+    }
+}
+
+void BBS::generate(uint8_t* data, size_t size, size_t threads)
+{
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t chunk = (size + threads - 1) / threads;
+    if (threads == 1 or chunk < _modulo.bitsLen() * _bitsPerStep) {
+        generate(data, size);
+        return;
+    }
+
+    // Workers are copies made before any of them runs. This generator fills the first
+    // chunk itself and moves past the whole buffer at the end.
+    uint64_t firstBit = _position * _bitsPerStep - _pendingBits;
+    std::vector<BBS> workers(threads - 1, *this);
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads and i * chunk < size; ++i) {
+        pool.emplace_back([&worker = workers[i - 1], data, size, chunk, firstBit, i]() {
+            size_t from = i * chunk;
+            worker.seekBit(firstBit + 8 * uint64_t(from));
+            worker.generate(data + from, std::min(chunk, size - from));
+        });
+    }
+    generate(data, chunk);
+    for (std::thread& thread : pool)
+        thread.join();
+    seekBit(firstBit + 8 * uint64_t(size));
+}
+
+void BBS::seek(uint64_t step)
+{
+    // x_0 is coprime to n, so its exponents can be reduced modulo lambda(n)
+    BigInt exponent = modPow(2, fromUint64(step), _carmichael);
+    _state = _modulo.toWorking(_modulo.powMod(_seed, exponent));
+    _position = step;
+    _pending = 0;
+    _pendingBits = 0;
 }
 
-BigInt BBS::getRandSeed(word nBits, std::uniform_int_distribution<word>& distr, std::default_random_engine& gen)
+void BBS::seekBit(uint64_t bit)
 {
-    std::vector<word> seedHeap(std::max(std::ceil(nBits / bitsInWord), 1.0), 0);
-    std::fill(seedHeap.begin(), seedHeap.end(), distr(gen));
-    BigInt result(std::move(seedHeap));
+    seek(bit / _bitsPerStep);
+    size_t skipped = bit % _bitsPerStep;
+    if (skipped != 0) {
+        _pending = nextBits() >> skipped;
+        _pendingBits = _bitsPerStep - skipped;
+    }
+}
 
-    result = result >> static_cast<word>(std::ceil(nBits / bitsInWord)) % nBits;
-    return result;
+uint64_t BBS::position() const
+{
+    return _position;
+}
+
+size_t BBS::bitsPerStep() const
+{
+    return _bitsPerStep;
+}
+
+const BigInt& BBS::getModulo() const
+{
+    return _modulo.getModulo();
 }
@@ -3,22 +3,64 @@
 
 #include "bigint.h"
 #include "bigintfunct.h"
+#include "modcontext.h"
 
-#include <chrono>
-#include <random>
+#include <cstdint>
+#include <utility>
 
+// Blum Blum Shub generator: x_{i+1} = x_i^2 mod n for n = p * q of two Blum primes
+// (p = q = 3 mod 4). Every step gives out the log2(log2(n)) low bits of the state only,
+// the more bits the weaker the link to factoring n.
+// The factors are kept, so any state is reachable directly as x_i = x_0^(2^i mod lambda(n)).
 class BBS
 {
 public:
+    // Modulo of nBits bits from two random Blum primes and a random seed
     explicit BBS(word nBits);
-    BBS(BigInt p, BigInt q, word nBits);
+    // Known factors with a random seed. p and q have to be distinct Blum primes,
+    // std::logic_error is thrown otherwise.
+    BBS(const BigInt& p, const BigInt& q);
+    // Known factors and seed, x_0 = seed^2 mod n. The seed has to be coprime to n = p * q.
+    BBS(const BigInt& p, const BigInt& q, const BigInt& seed);
+
+    // Low bitsPerStep() bits of the next state
     BigInt getRandomBits();
+    // Fills the buffer with the bits of the next states, bitsPerStep() per state packed from
+    // the least significant bit of every byte. Bits left over from a step are kept for the
+    // next call, so a stream does not depend on how it is split into buffers.
+    void generate(uint8_t* data, size_t size);
+    // Same bytes as generate(data, size), the buffer is split into one contiguous chunk per
+    // thread (0 for one per core) and every thread jumps to the start of its chunk.
+    // A jump costs about as much as bitsLen(n) steps, short buffers are filled sequentially.
+    void generate(uint8_t* data, size_t size, size_t threads);
+
+    // Moves to step i: the next output is the one of x_{i+1}, as right after construction
+    // for i = 0. Bits left over from the previous steps are dropped.
+    void seek(uint64_t step);
+    // Steps done so far
+    uint64_t position() const;
+
+    size_t bitsPerStep() const;
+    const BigInt& getModulo() const;
 
 private:
-    BigInt getRandSeed(word nBits, std::uniform_int_distribution<word>& distr, std::default_random_engine& gen);
+    explicit BBS(const std::pair<BigInt, BigInt>& factors);
+
+    // Advances the state and returns its low bits
+    word nextBits();
+    // Moves to the given bit of the stream of generate
+    void seekBit(uint64_t bit);
 
+    ModContext _modulo;
+    // lambda(n) = lcm(p - 1, q - 1)
+    BigInt _carmichael;
+    BigInt _seed;
+    // Current state in the working representation of _modulo
     BigInt _state;
-    BigInt _modulo;
+    uint64_t _position = 0;
+    size_t _bitsPerStep;
+    uint64_t _pending = 0;
+    size_t _pendingBits = 0;
 };
 
 #endif // BBS_H
@@ -1,16 +1,24 @@
 #include "gost.h"
+#include "bigintfunct.h"
 #include "primality.h"
 
-#include <chrono>
 #include <random>
 
+static BigInt ceilDivision(const BigInt& numerator, const BigInt& denominator)
+{
+    auto [quotient, remainder] = divisionRemainder(numerator, denominator);
+    if (not remainder.isZero())
+        quotient += 1;
+    return quotient;
+}
+
 GOST::GOST()
 {
     std::random_device rd;
     std::default_random_engine gen{rd()};
-    constexpr uint32_t max16Word = 1 << 16;
-    std::uniform_int_distribution<uint32_t> distr(0, max16Word);
-    _paramC = distr(gen);
+    std::uniform_int_distribution<uint16_t> distr(0, UINT16_MAX);
+    // The procedure needs an odd increment
+    _paramC = distr(gen) | 1;
     _state = distr(gen);
 }
 
@@ -19,67 +27,48 @@ BigInt GOST::getRandomBits(word nBits)
     if (nBits < 17)
         throw std::logic_error("GOST random generator is not capable of generationg numbers that small");
 
-    _congr32State = _state;
-    // Compute ts
-    std::vector<word> variablesT;
-    variablesT.push_back(nBits);
-    for (word i = 1;; ++i) {
-        word tNew = std::floor(variablesT[i - 1] / 2);
-        if (tNew >= 17)
-            variablesT.push_back(tNew);
-        else
-            break;
+    // Lengths t_0 = nBits, t_{i+1} = t_i / 2 down to the first one below 17
+    std::vector<size_t> variablesT = {nBits};
+    while (variablesT.back() >= 17)
+        variablesT.push_back(variablesT.back() / 2);
+
+    // p_s is the least prime of t_s bits (from 8 to 16 bits, so there is one), then
+    // every p_m = p_{m+1} * (N + k) + 1 is proven prime by 2^(p_m - 1) = 1 and
+    // 2^(N + k) != 1 (mod p_m)
+    BigInt p = *searchPrime((BigInt(1) << (variablesT.back() - 1)) + 1, 2, BigInt(1) << variablesT.back());
+    for (size_t m = variablesT.size() - 1; m-- > 0;) {
+        size_t rm = (variablesT[m] + 15) / 16;
+        BigInt bound = BigInt(1) << (variablesT[m] - 1);
+        auto test = [&p](const BigInt& pm) {
+            BigInt exponent = pm - 1;
+            return modPow(2, exponent, pm) == 1
+                   and modPow(2, divisionRemainder(exponent, p).first, pm) != 1;
+        };
+
+        while (true) {
+            // Y = sum of y_{i+1} * 2^(16 * i)
+            BigInt Y = 0;
+            for (size_t i = 0; i < rm; ++i)
+                Y += BigInt(congruent16()) << (16 * i);
+
+            BigInt N = ceilDivision(bound, p) + ceilDivision(bound * Y, p << (16 * rm));
+            if (N.getBitAt(0))
+                N += 1;
+
+            // Candidates p * (N + k) + 1 for even k up to 2^t_m
+            std::optional<BigInt> pm = searchPrime(p * N + 1, p << 1, (bound << 1) + 1, false, test);
+            if (pm) {
+                p = std::move(*pm);
+                break;
+            }
+        }
     }
-    // Find prime Ps
-    uint64_t p = blumsPrime(variablesT.back());
-    int32_t m = variablesT.size() - 2;
-
-    BigInt k = 0;
-step5:
-    word rm = std::ceil(variablesT[m + 1] / 16);
-
-    // Generate ys
-step6:
-    std::vector<BigInt> variablesY;
-    for (word i = 0; i < rm; ++i)
-        variablesY.push_back(congruent32());
-
-    BigInt Y = 0;
-    BigInt pow2to161 = 1;
-    pow2to161 <<= 161;
-
-    for (word i = 0; i < rm - 1; ++i)
-        Y = Y + variablesY[i] * pow2to161;
-
-    _congr32State = variablesY[std::min(rm, 0u)];
-    BigInt N = divisionRemainder((1 << (variablesT[m] - 1)), p).first + divisionRemainder((1 << variablesT[m]) * Y, (p * (1 << (16 * rm)))).first;
-    if (N.getBitAt(0) == 1)
-        N = N + 1;
-
-step11:
-    BigInt pm = p * (N + k) + 1;
-
-    if (pm > (1 << (variablesT[m])))
-        goto step6;
-
-    BigInt exp1 = m;
-    exp1 = exp1.binarySWExp(N + k);
-    if ((BigInt(2).binarySWExp(exp1) % pm) != 1 or (BigInt(2).binarySWExp(N + k) % pm) != 1) {
-        k = k + 2;
-        goto step11;
-    }
-
-    m = m - 1;
-
-    if (m >= 0)
-        goto step5;
 
     return p;
-
 }
 
-BigInt GOST::congruent32()
+uint16_t GOST::congruent16()
 {
-    _congr32State = (_paramB * _congr32State + BigInt(_paramC)) % _modulo32;
-    return _congr32State;
+    _state = static_cast<uint16_t>(_paramB * _state + _paramC);
+    return _state;
 }
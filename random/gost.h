@@ -2,26 +2,28 @@
 #define GOST_H
 
 #include "bigint.h"
-#include "bigintfunct.h"
 
 #include <cstdint>
 
 
+// Prime numbers of GOST R 34.10-94, procedure A: a prime p_m of t_m bits is built
+// from a prime p_{m+1} of about half as many bits as p_m = p_{m+1} * (N + k) + 1,
+// with N drawn from a 16-bit linear congruential generator.
 class GOST
 {
 public:
     explicit GOST();
+    // Prime of exactly nBits bits, nBits is at least 17
     BigInt getRandomBits(word nBits);
 
 private:
-    BigInt congruent32();
+    // y = (19381 * y + c) mod 2^16
+    uint16_t congruent16();
 
     uint16_t _paramC;
-    BigInt _state;
-    BigInt _congr32State;
+    uint16_t _state;
 
-    BigInt _modulo32 = (BigInt(1) << word(32));
-    BigInt _paramB = 19381;
+    static constexpr uint32_t _paramB = 19381;
 };
 
 #endif // GOST_H
@@ -1,7 +1,12 @@
 #include "bbs.h"
 #include "gost.h"
+#include "primality.h"
 
+#include <chrono>
 #include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
 
 #include <boost/tokenizer.hpp>
 #include <boost/program_options.hpp>
@@ -15,8 +20,10 @@ int main(int argc, const char* argv[])
     options.add_options()
             ("help,h", "Prints this message")
             ("nbits,n", poptions::value<word>(), "N bits to generate randomly")
-            ("mode,m", poptions::value<std::string>(), "Input algorighm mode (bbs or gost)")
+            ("mode,m", poptions::value<std::string>(), "Input algorighm mode (bbs, gost or primes to time the prime search)")
             ("iterations,i", poptions::value<word>(), "Input how many numbers to generate")
+            ("throughput,t", poptions::value<size_t>(), "Measure bbs speed on the given number of MB")
+            ("threads,j", poptions::value<size_t>(), "Threads for the bbs and primes speed measures, 0 for one per core")
             ("radix,r", poptions::value<std::string>(), "Input radix for input and output");
 
     poptions::positional_options_description positional;
@@ -59,6 +66,48 @@ int main(int argc, const char* argv[])
         if (variables.count("iterations"))
             iterations = variables["iterations"].as<word>();
 
+        if (mode == "bbs" and variables.count("throughput")) {
+            // The whole buffer in one call, so the threads and their seeks are paid once,
+            // measured sequentially and then with the given number of threads
+            BBS generator(variables["nbits"].as<word>());
+            size_t megabytes = variables["throughput"].as<size_t>();
+            size_t threads = variables.count("threads") ? variables["threads"].as<size_t>() : 0;
+            std::vector<uint8_t> buffer(megabytes << 20);
+            auto measure = [&](size_t generateThreads) {
+                auto start = std::chrono::steady_clock::now();
+                generator.generate(buffer.data(), buffer.size(), generateThreads);
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                return megabytes / elapsed.count();
+            };
+            double sequential = measure(1);
+            double parallel = measure(threads);
+            std::cout << megabytes << " MB with " << generator.bitsPerStep() << " bits per step: " << sequential
+                      << " MB/s with 1 thread, " << parallel << " MB/s with "
+                      << (threads == 0 ? std::thread::hardware_concurrency() : threads) << " threads" << std::endl;
+            return 0;
+        }
+
+        if (mode == "primes") {
+            // The same random starts with one thread and with the given number of them,
+            // so both searches go through the same candidates
+            word nBits = variables["nbits"].as<word>();
+            size_t threads = variables.count("threads") ? variables["threads"].as<size_t>() : 0;
+            auto measure = [&](size_t searchThreads) {
+                std::mt19937_64 gen(nBits);
+                auto start = std::chrono::steady_clock::now();
+                for (word i = 0; i < iterations; ++i)
+                    randomPrime(nBits, PrimeKind::Blum, gen, searchThreads);
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                return elapsed.count() / iterations;
+            };
+            double sequential = measure(1);
+            double parallel = measure(threads);
+            std::cout << nBits << "-bit Blum primes: " << sequential << " ms with 1 thread, " << parallel
+                      << " ms with " << (threads == 0 ? std::thread::hardware_concurrency() : threads)
+                      << " threads, speedup " << sequential / parallel << std::endl;
+            return 0;
+        }
+
         std::cout << "Random generated value: " << std::endl;
         if (mode == "bbs") {
             BBS generator(variables["nbits"].as<word>());
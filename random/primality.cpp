@@ -0,0 +1,522 @@
+#include "primality.h"
+#include "bigintfunct.h"
+#include "bigintkernel.h"
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// Trial division of big candidates stops at this prime, the tests after it are cheaper
+// than dividing further
+constexpr uint32_t trialDivisionLimit = 2000;
+// Candidates sieved at once by the prime search
+constexpr size_t sieveWindow = 4096;
+// The parallel search hands out smaller windows: a window of big candidates usually holds
+// fewer than ten survivors of the sieve, and the prime is usually found among the first
+// few dozen of them
+constexpr size_t parallelSieveWindow = 64;
+
+const std::vector<uint32_t>& smallPrimes()
+{
+    static const std::vector<uint32_t> primes = [] {
+        constexpr uint32_t limit = 1 << 16;
+        std::vector<bool> composite(limit, false);
+        std::vector<uint32_t> result;
+        for (uint32_t i = 2; i < limit; ++i) {
+            if (composite[i])
+                continue;
+            result.push_back(i);
+            for (uint32_t j = i * i; j < limit; j += i)
+                composite[j] = true;
+        }
+        return result;
+    }();
+    return primes;
+}
+
+// Products of consecutive odd small primes that fit in a word, the remainder modulo
+// a product gives the remainders modulo all of its primes with one division of the candidate
+struct PrimeGroup
+{
+    word product;
+    size_t first;
+    size_t last;
+};
+
+static std::vector<PrimeGroup> makePrimeGroups(uint32_t limit)
+{
+    const std::vector<uint32_t>& primes = smallPrimes();
+    std::vector<PrimeGroup> result;
+    for (size_t i = 1; i < primes.size() and primes[i] < limit;) {
+        PrimeGroup group = {1, i, i};
+        while (group.last < primes.size() and primes[group.last] < limit
+               and group.product <= maxWord / primes[group.last])
+            group.product *= primes[group.last++];
+        result.push_back(group);
+        i = group.last;
+    }
+    return result;
+}
+
+static const std::vector<PrimeGroup>& trialDivisionGroups()
+{
+    static const std::vector<PrimeGroup> groups = makePrimeGroups(trialDivisionLimit);
+    return groups;
+}
+
+// Every odd small prime
+static const std::vector<PrimeGroup>& sieveGroups()
+{
+    static const std::vector<PrimeGroup> groups = makePrimeGroups(~uint32_t(0));
+    return groups;
+}
+
+static uint64_t mulMod64(uint64_t left, uint64_t right, uint64_t modulo)
+{
+#ifdef __SIZEOF_INT128__
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(left) * right) % modulo);
+#else
+    // Double-and-add, every intermediate value stays below 2 * modulo
+    uint64_t result = 0;
+    left %= modulo;
+    for (; right != 0; right >>= 1) {
+        if (right & 1)
+            result = result >= modulo - left ? result - (modulo - left) : result + left;
+        left = left >= modulo - left ? left - (modulo - left) : left + left;
+    }
+    return result;
+#endif
+}
+
+static uint64_t powMod64(uint64_t base, uint64_t exponent, uint64_t modulo)
+{
+    uint64_t result = 1 % modulo;
+    base %= modulo;
+    for (; exponent != 0; exponent >>= 1) {
+        if (exponent & 1)
+            result = mulMod64(result, base, modulo);
+        base = mulMod64(base, base, modulo);
+    }
+    return result;
+}
+
+bool isPrime(uint64_t op)
+{
+    // The first 12 primes as bases decide primality of all numbers below 2^64
+    constexpr std::array<uint64_t, 12> bases = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    if (op < 2)
+        return false;
+    for (uint64_t prime : bases) {
+        if (op % prime == 0)
+            return op == prime;
+    }
+
+    uint64_t d = op - 1;
+    unsigned s = 0;
+    for (; (d & 1) == 0; d >>= 1)
+        ++s;
+
+    for (uint64_t base : bases) {
+        uint64_t x = powMod64(base, d, op);
+        if (x == 1 or x == op - 1)
+            continue;
+
+        bool witness = true;
+        for (unsigned r = 1; r < s and witness; ++r) {
+            x = mulMod64(x, x, op);
+            witness = x != op - 1;
+        }
+        if (witness)
+            return false;
+    }
+    return true;
+}
+
+bool millerRabinTest(const ModContext& context, const BigInt& base)
+{
+    const BigInt& op = context.getModulo();
+    BigInt minusOne = op - 1;
+    size_t s = 0;
+    while (not minusOne.getBitAt(s))
+        ++s;
+    BigInt d = minusOne >> s;
+
+    // The squarings stay in the working representation
+    BigInt x = context.toWorking(context.powMod(base, d));
+    BigInt workingMinusOne = context.toWorking(minusOne);
+    if (x == context.workingOne() or x == workingMinusOne)
+        return true;
+
+    for (size_t r = 1; r < s; ++r) {
+        context.sqrWorking(x, x);
+        if (x == workingMinusOne)
+            return true;
+        if (x == context.workingOne())
+            return false;
+    }
+    return false;
+}
+
+// Modular helpers for the operands of the Lucas sequences, all below modulo
+static void addMod(BigInt& result, const BigInt& op, const BigInt& modulo)
+{
+    result += op;
+    if (result >= modulo)
+        result -= modulo;
+}
+
+static void subMod(BigInt& result, const BigInt& op, const BigInt& modulo)
+{
+    if (result < op)
+        result += modulo;
+    result -= op;
+}
+
+// result / 2 modulo an odd number
+static void halfMod(BigInt& result, const BigInt& modulo)
+{
+    if (result.getBitAt(0))
+        result += modulo;
+    result >>= 1;
+}
+
+// Jacobi symbol (a/n) of small numbers, n is odd
+static int jacobi(uint64_t a, uint64_t n)
+{
+    int result = 1;
+    a %= n;
+    while (a != 0) {
+        for (; (a & 1) == 0; a >>= 1) {
+            if (n % 8 == 3 or n % 8 == 5)
+                result = -result;
+        }
+        std::swap(a, n);
+        if (a % 4 == 3 and n % 4 == 3)
+            result = -result;
+        a %= n;
+    }
+    return n == 1 ? result : 0;
+}
+
+static word remainderWord(const BigInt& op, word divisor, LimbVector& scratch)
+{
+    scratch.resize(op.wordLen());
+    return divModWord(scratch.data(), op.getHeap().data(), op.wordLen(), divisor);
+}
+
+// Jacobi symbol (d/op) of a small signed d, op is odd
+static int jacobi(int64_t d, const BigInt& op, LimbVector& scratch)
+{
+    uint64_t magnitude = static_cast<uint64_t>(d < 0 ? -d : d);
+    // Reciprocity for the odd magnitude, (-1/op) = (-1)^((op - 1) / 2) for the sign
+    int result = jacobi(remainderWord(op, static_cast<word>(magnitude), scratch), magnitude);
+    bool opIs3Mod4 = op.getBitAt(1);
+    if (magnitude % 4 == 3 and opIs3Mod4)
+        result = -result;
+    if (d < 0 and opIs3Mod4)
+        result = -result;
+    return result;
+}
+
+static bool isPerfectSquare(const BigInt& op)
+{
+    // Newton's iteration from above converges to floor(sqrt(op))
+    BigInt root = BigInt(1) << ((op.bitsLen() + 1) / 2);
+    while (true) {
+        BigInt next = (root + divisionRemainder(op, root).first) >> 1;
+        if (next >= root)
+            break;
+        root = std::move(next);
+    }
+    return root * root == op;
+}
+
+bool strongLucasTest(const BigInt& op)
+{
+    // A perfect square has no D with (D/op) = -1, it is checked once a few D failed
+    constexpr int64_t squareCheckAfter = 20;
+    LimbVector scratch;
+    int64_t d = 5;
+    for (int64_t i = 0;; ++i, d = d > 0 ? -(d + 2) : -d + 2) {
+        if (i == squareCheckAfter and isPerfectSquare(op))
+            return false;
+
+        int symbol = jacobi(d, op, scratch);
+        if (symbol == -1)
+            break;
+        if (symbol == 0)
+            return op == BigInt(static_cast<word>(d < 0 ? -d : d));
+    }
+
+    // op + 1 = k * 2^s with odd k
+    BigInt k = op + 1;
+    size_t s = 0;
+    while (not k.getBitAt(s))
+        ++s;
+    k >>= s;
+
+    // Sequences are kept in the working representation of the context, which commutes
+    // with the additions and the halving. P = 1, so U_1 = V_1 = 1.
+    ModContext context(op);
+    int64_t q = (1 - d) / 4;
+    auto smallModulo = [&op](int64_t value) {
+        BigInt magnitude(static_cast<word>(value < 0 ? -value : value));
+        return value < 0 ? op - magnitude : magnitude;
+    };
+    BigInt workingD = context.toWorking(smallModulo(d));
+    BigInt workingQ = context.toWorking(smallModulo(q));
+    BigInt u = context.workingOne();
+    BigInt v = context.workingOne();
+    BigInt qPower = workingQ;
+    BigInt temp;
+    for (size_t bit = k.bitsLen() - 1; bit > 0; --bit) {
+        // U_2j = U_j * V_j, V_2j = V_j^2 - 2 * Q^j
+        context.mulWorking(u, u, v);
+        context.sqrWorking(v, v);
+        subMod(v, qPower, op);
+        subMod(v, qPower, op);
+        context.sqrWorking(qPower, qPower);
+        if (k.getBitAt(bit - 1)) {
+            // U_2j+1 = (U_2j + V_2j) / 2, V_2j+1 = (D * U_2j + V_2j) / 2
+            context.mulWorking(temp, workingD, u);
+            addMod(u, v, op);
+            halfMod(u, op);
+            addMod(v, temp, op);
+            halfMod(v, op);
+            context.mulWorking(qPower, qPower, workingQ);
+        }
+    }
+
+    // Strong test: U_k = 0 or V_(k * 2^r) = 0 for some 0 <= r < s
+    if (u.isZero() or v.isZero())
+        return true;
+    for (size_t r = 1; r < s; ++r) {
+        context.sqrWorking(v, v);
+        subMod(v, qPower, op);
+        subMod(v, qPower, op);
+        if (v.isZero())
+            return true;
+        context.sqrWorking(qPower, qPower);
+    }
+    return false;
+}
+
+// op has at most 64 bits
+bool isProbablePrime(const BigInt& op)
+{
+    if (op.bitsLen() <= 64)
+        return isPrime(toUint64(op));
+    if (not op.getBitAt(0))
+        return false;
+
+    LimbVector scratch;
+    const std::vector<uint32_t>& primes = smallPrimes();
+    for (const PrimeGroup& group : trialDivisionGroups()) {
+        word remainder = remainderWord(op, group.product, scratch);
+        for (size_t i = group.first; i < group.last; ++i) {
+            if (remainder % primes[i] == 0)
+                return false;
+        }
+    }
+
+    return millerRabinTest(ModContext(op), 2) and strongLucasTest(op);
+}
+
+// Remainders of op modulo every small prime (index 0, the prime 2, is left zero)
+static std::vector<uint32_t> smallResidues(const BigInt& op)
+{
+    const std::vector<uint32_t>& primes = smallPrimes();
+    std::vector<uint32_t> result(primes.size(), 0);
+    LimbVector scratch;
+    for (const PrimeGroup& group : sieveGroups()) {
+        word remainder = remainderWord(op, group.product, scratch);
+        for (size_t i = group.first; i < group.last; ++i)
+            result[i] = static_cast<uint32_t>(remainder % primes[i]);
+    }
+    return result;
+}
+
+// Inverse of a non-zero op modulo a prime, op^(prime - 2)
+static uint64_t inverseModPrime(uint64_t op, uint64_t prime)
+{
+    uint64_t result = 1;
+    for (uint64_t exponent = prime - 2; exponent != 0; exponent >>= 1, op = op * op % prime) {
+        if (exponent & 1)
+            result = result * op % prime;
+    }
+    return result;
+}
+
+// Small factors of the candidates start + i * step. For every odd small prime r not dividing
+// the step the candidates divisible by r are i = -start / step (mod r). For safe primes
+// (p - 1) / 2 is sieved too, those are p = 1 (mod r). The residues are computed once,
+// any range of i is sieved from them, so threads can share one sieve.
+class CandidateSieve
+{
+public:
+    CandidateSieve(const BigInt& start, const BigInt& step, bool safe)
+        : _startResidues(smallResidues(start))
+        , _stepResidues(smallResidues(step))
+        , _stepInverses(_stepResidues.size(), 0)
+        , _safe(safe)
+    {
+        const std::vector<uint32_t>& primes = smallPrimes();
+        for (size_t j = 1; j < primes.size(); ++j) {
+            if (_stepResidues[j] != 0)
+                _stepInverses[j] = static_cast<uint32_t>(inverseModPrime(_stepResidues[j], primes[j]));
+        }
+    }
+
+    // composite[i] tells if the candidate offset + i has a small factor
+    void sieve(uint64_t offset, std::vector<bool>& composite) const
+    {
+        const std::vector<uint32_t>& primes = smallPrimes();
+        std::fill(composite.begin(), composite.end(), false);
+        for (size_t j = 1; j < primes.size(); ++j) {
+            uint64_t prime = primes[j];
+            if (_stepResidues[j] == 0)
+                continue;
+
+            uint64_t residue = (_startResidues[j] + offset % prime * _stepResidues[j]) % prime;
+            mark((prime - residue) * _stepInverses[j] % prime, prime, composite);
+            if (_safe)
+                mark((prime + 1 - residue) % prime * _stepInverses[j] % prime, prime, composite);
+        }
+    }
+
+private:
+    static void mark(uint64_t first, uint64_t prime, std::vector<bool>& composite)
+    {
+        for (uint64_t i = first; i < composite.size(); i += prime)
+            composite[i] = true;
+    }
+
+    std::vector<uint32_t> _startResidues;
+    std::vector<uint32_t> _stepResidues;
+    std::vector<uint32_t> _stepInverses;
+    bool _safe;
+};
+
+// Candidates below 2^16 could be the sieving primes themselves and short ranges
+// are not worth sieving, both are tested directly
+static bool isSieved(const BigInt& start, const BigInt& limit)
+{
+    return start.bitsLen() > 16 and limit.bitsLen() > 32;
+}
+
+std::optional<BigInt> searchPrime(const BigInt& start, const BigInt& step, const BigInt& limit, bool safe,
+                                  const std::function<bool(const BigInt&)>& test)
+{
+    if (not start.getBitAt(0) or step.getBitAt(0) or step.isZero())
+        throw std::logic_error("Prime search needs an odd start and an even step");
+
+    auto passes = [&](const BigInt& candidate) {
+        return test(candidate) and (not safe or isProbablePrime(candidate >> 1));
+    };
+
+    if (not isSieved(start, limit)) {
+        for (BigInt candidate = start; candidate < limit; candidate += step) {
+            if (passes(candidate))
+                return candidate;
+        }
+        return std::nullopt;
+    }
+
+    CandidateSieve candidates(start, step, safe);
+    std::vector<bool> composite(sieveWindow);
+    BigInt candidate = start;
+    for (uint64_t offset = 0;; offset += sieveWindow) {
+        candidates.sieve(offset, composite);
+        for (size_t i = 0; i < sieveWindow; ++i, candidate += step) {
+            if (candidate >= limit)
+                return std::nullopt;
+            if (not composite[i] and passes(candidate))
+                return candidate;
+        }
+    }
+}
+
+std::optional<BigInt> searchPrimeParallel(const BigInt& start, const BigInt& step, const BigInt& limit,
+                                          size_t threads, bool safe,
+                                          const std::function<bool(const BigInt&)>& test)
+{
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (threads == 1 or not isSieved(start, limit))
+        return searchPrime(start, step, limit, safe, test);
+    if (not start.getBitAt(0) or step.getBitAt(0) or step.isZero())
+        throw std::logic_error("Prime search needs an odd start and an even step");
+
+    // Workers take the windows in order. A prime found in a window cancels the windows
+    // after it, the ones before it still run to the end, so the result is the first prime
+    // of the progression, the same as of searchPrime.
+    CandidateSieve candidates(start, step, safe);
+    std::atomic<uint64_t> nextWindow = 0;
+    std::atomic<uint64_t> foundWindow = std::numeric_limits<uint64_t>::max();
+    std::mutex resultMutex;
+    std::optional<BigInt> result;
+    std::exception_ptr error;
+
+    auto worker = [&]() {
+        std::vector<bool> composite(parallelSieveWindow);
+        try {
+            while (true) {
+                uint64_t window = nextWindow++;
+                if (window >= foundWindow)
+                    return;
+
+                uint64_t offset = window * parallelSieveWindow;
+                BigInt candidate = start + step * fromUint64(offset);
+                if (candidate >= limit)
+                    return;
+                candidates.sieve(offset, composite);
+                for (size_t i = 0; i < parallelSieveWindow; ++i, candidate += step) {
+                    if (window > foundWindow or candidate >= limit)
+                        return;
+                    if (composite[i] or not test(candidate) or (safe and not isProbablePrime(candidate >> 1)))
+                        continue;
+
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    if (window < foundWindow) {
+                        foundWindow = window;
+                        result = std::move(candidate);
+                    }
+                    return;
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (not error)
+                error = std::current_exception();
+            foundWindow = 0;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread& thread : pool)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+    return result;
+}
+
+BigInt blumsPrime(size_t nBits)
+{
+    if (nBits < 2)
+        throw std::logic_error("There are no Blum primes that small");
+    if (nBits == 2)
+        return 3;
+
+    BigInt limit = BigInt(1) << nBits;
+    std::optional<BigInt> prime = searchPrime((limit >> 1) + 3, 4, limit);
+    if (not prime)
+        throw std::logic_error("No Blum prime of the given length");
+    return *prime;
+}
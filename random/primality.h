@@ -1,68 +1,136 @@
-#ifndef RANDOM_H
-#define RANDOM_H
+#ifndef PRIMALITY_H
+#define PRIMALITY_H
 
 #include "bigint.h"
 #include "bigintfunct.h"
+#include "modcontext.h"
 
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <optional>
 #include <random>
-#include <chrono>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
-// Miller-Rabin primality test
-bool primalityTest(const uint64_t &prime, unsigned iterations)
+// Primes below 2^16 in increasing order, for trial division and sieving
+const std::vector<uint32_t>& smallPrimes();
+
+// Deterministic Miller-Rabin test, exact for every 64-bit number
+bool isPrime(uint64_t op);
+
+// Strong probable prime test of an odd modulo > 3 to the given base (Miller-Rabin round)
+bool millerRabinTest(const ModContext& context, const BigInt& base);
+// Strong Lucas probable prime test with Selfridge's parameters (P = 1, Q = (1 - D) / 4
+// for the first D of 5, -7, 9, -11, ... with Jacobi symbol (D/op) = -1), op is odd
+bool strongLucasTest(const BigInt& op);
+// Baillie-PSW test: trial division by small primes, Miller-Rabin to base 2 and a strong
+// Lucas test. Exact below 2^64, no composite passing it is known above.
+bool isProbablePrime(const BigInt& op);
+
+// First prime among start, start + step, start + 2 * step, ... below limit that passes
+// the test, nothing if there is none. start must be odd and step even, so congruence
+// conditions like p = 3 (mod 4) or p = 1 (mod 2 * q) come from the choice of them.
+// Windows of candidates are sieved by all small primes, with residues updated from window
+// to window, and only the survivors get the test. With safe set (p - 1) / 2 is sieved
+// and has to be prime as well.
+std::optional<BigInt> searchPrime(const BigInt& start, const BigInt& step, const BigInt& limit,
+                                  bool safe = false,
+                                  const std::function<bool(const BigInt&)>& test = isProbablePrime);
+// Same result as searchPrime, with the windows of candidates spread over the given number
+// of threads, 0 for one per core. The test is called from all of them at once.
+std::optional<BigInt> searchPrimeParallel(const BigInt& start, const BigInt& step, const BigInt& limit,
+                                          size_t threads = 0, bool safe = false,
+                                          const std::function<bool(const BigInt&)>& test = isProbablePrime);
+
+enum class PrimeKind
 {
-    // initial conditions
-    if (prime == 0) {
-        return false;
-    } else if (prime == 1) {
-        return true;
-    } else if (prime % 2 == 0) {
-        return false;
-    } else {
-        // get prime - 1 as (2^s)*t (t is odd)
-        uint64_t t = prime - 1;
-        uint64_t s = 0;
-        while ((t % 2) == 0) {
-            t = std::floor(t / 2);
-            s += 1;
-        }
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<unsigned long> distr(2, maxWord);
-        for (unsigned i = 0; i < iterations; i++) {
-            uint64_t base = distr(gen);
-            uint64_t exp = static_cast<uint64_t>(std::pow(base, t)) % prime;
-            if (exp == 1 || exp == prime - 1) {
-                continue;
-            } else {
-                for (unsigned j = 0; j < s - 1; j++) {
-                    exp = static_cast<uint64_t>(std::pow(exp, 2)) % prime;
-                    if (exp == 1) {
-                        return false;
-                    } else if (exp == prime - 1) {
-                        break;
-                    }
-                }
-                return false;
-            }
-        }
-        return true;
-    }
-}
+    Any,
+    // p = 3 (mod 4)
+    Blum,
+    // (p - 1) / 2 is prime too, for p > 7 these are Blum primes as well
+    Safe
+};
 
+// Random number of exactly nBits bits
+template <typename Generator>
+BigInt randomBits(size_t nBits, Generator& gen)
+{
+    std::uniform_int_distribution<word> distr(0, maxWord);
+    std::vector<word> heap(std::max<size_t>((nBits + bitsInWord - 1) / bitsInWord, 1));
+    for (word& limb : heap)
+        limb = distr(gen);
+
+    size_t topBits = nBits % bitsInWord;
+    if (topBits != 0)
+        heap.back() &= maxWord >> (bitsInWord - topBits);
+    BigInt result(std::move(heap));
+    if (nBits != 0)
+        result.setBitAt(nBits - 1, true);
+    return result;
+}
 
-uint64_t blumsPrime(uint64_t nBits)
+// Random prime of exactly nBits bits: the search starts at a random point
+// and moves on to another one if it runs out of the range. With threads other than 1
+// the search is parallel, 0 takes one thread per core.
+// The two top bits of the start are set, so the product of two such primes
+// has exactly the sum of their lengths.
+template <typename Generator>
+BigInt randomPrime(size_t nBits, PrimeKind kind, Generator& gen, size_t threads = 1)
 {
-    if (nBits >= 64)
-        throw std::logic_error("Blums prime generator is not capable of generating numbers that big");
+    if (nBits < (kind == PrimeKind::Safe ? 3 : 2))
+        throw std::logic_error("There are no such primes that small");
 
-    uint64_t max(1);
-    max <<= nBits;
-    uint64_t maxQuotient = std::ceil(max / 4);
+    BigInt limit = BigInt(1) << nBits;
+    while (true) {
+        BigInt start = randomBits(nBits, gen);
+        start.setBitAt(nBits - 2, true);
+        start.setBitAt(0, true);
+        if (kind != PrimeKind::Any)
+            start.setBitAt(1, true);
+        std::optional<BigInt> prime = searchPrimeParallel(start, kind == PrimeKind::Any ? 2 : 4, limit,
+                                                          threads, kind == PrimeKind::Safe);
+        if (prime)
+            return *prime;
+    }
+}
 
-    for (size_t i = 1; primalityTest(4 * maxQuotient + 3, 5); ++i)
-        maxQuotient++;
+// Generator for another thread. Engines are seeded from gen through a seed sequence:
+// a linear congruential engine seeded with its own output directly would repeat the stream
+// of gen. Sources without a seed like std::random_device are simply opened once more.
+template <typename Generator>
+Generator forkGenerator(Generator& gen)
+{
+    if constexpr (std::is_constructible_v<Generator, std::seed_seq&>) {
+        std::seed_seq seeds = {gen(), gen()};
+        return Generator(seeds);
+    } else {
+        return Generator();
+    }
+}
+
+// Two independent random primes of pBits and qBits bits, e.g. the factors of a BBS or Rabin
+// modulo. Both are searched at once, each on its half of the threads (0 for all cores).
+template <typename Generator>
+std::pair<BigInt, BigInt> randomPrimePair(size_t pBits, size_t qBits, PrimeKind kind, Generator& gen,
+                                          size_t threads = 0)
+{
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t qThreads = std::max<size_t>(threads / 2, 1);
+    size_t pThreads = std::max<size_t>(threads - qThreads, 1);
 
-    return maxQuotient * 4 + 3;
+    // The generator is not shared between the searches
+    Generator pGen = forkGenerator(gen);
+    std::future<BigInt> p = std::async(std::launch::async, [&]() {
+        return randomPrime(pBits, kind, pGen, pThreads);
+    });
+    BigInt q = randomPrime(qBits, kind, gen, qThreads);
+    return {p.get(), std::move(q)};
 }
 
-#endif // RANDOM_H
+// Smallest Blum prime of nBits bits
+BigInt blumsPrime(size_t nBits);
+
+#endif // PRIMALITY_H